@@ -0,0 +1,26 @@
+// -------------------------------------------------------------------
+// Benchmark - timing of the render and configuration paths ('-D BENCHMARK')
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// samples per benchmark case, after untimed warm-up iterations (caches, first render of a changed
+// scene) and a pause in which the log and render tasks finish the work the warm-up left them
+const int BenchmarkIterations = 200;
+const int BenchmarkWarmupIterations = 20;
+const uint32_t BenchmarkSettleMillis = 50;
+// measurements of a case above its limits before it fails
+const int BenchmarkAttempts = 3;
+
+// Benchmark - render path (curve table, gradient, 'LEDColorControl()', dithered refresh), called by
+// the render task before its first command, it owns 'LEDStrip' and all frames at this point; the
+// dithered refresh is reported with its headroom within 'DitherFrameMillis', the strip cases with
+// 'PixelCount' (all strips)
+void BenchmarkRenderPath(int DitherFrameMillis, int PixelCount);
+
+// Benchmark - configuration path ('MQTTCallback()', 'NVSReadSettings()'), called by 'loop()',
+// runs once after the render path as soon as the system time is synchronized; host builds exit
+// afterwards with the number of cases above their limit as exit code
+void BenchmarkConfigPathService(bool isTimeSynced);
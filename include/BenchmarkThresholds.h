@@ -0,0 +1,57 @@
+// -------------------------------------------------------------------
+// Benchmark - regression limits, a case above its limit is reported as failed
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// limits in nanoseconds: 'Base' + 'PerPixel' * pixel count, for the median and the 99th percentile
+struct BenchmarkLimit {
+  const char* Case;
+  uint32_t MedianBase;
+  uint32_t MedianPerPixel;
+  uint32_t P99Base;
+  uint32_t P99PerPixel;
+};
+
+#ifdef ESP_PLATFORM
+// ESP32 at 240 MHz (software double precision in the curve table), 'LEDColorControl()' includes the
+// SK6812 output of 41 pixels (~1.6 ms)
+const BenchmarkLimit BenchmarkLimits[] = {
+  // case                      median base  per pixel   p99 base  per pixel
+  { "LEDRenderer/CurveUpdate",        20000,     40000,     40000,    60000 },
+  { "LEDRenderer/Render",              2000,       400,     10000,     1000 },
+  { "LEDColorControl",              2500000,         0,   4000000,        0 },
+  { "LEDStripShowFrames",           2500000,         0,   4000000,        0 },
+  { "MQTTCallback/LEDBrightness",    150000,         0,    600000,        0 },
+  { "MQTTCallback/LEDColorTop",      150000,         0,    600000,        0 },
+  { "MQTTCallback/Config",           300000,         0,   1000000,        0 },
+  { "MQTTCallback/Unknown",           10000,         0,     50000,        0 },
+  { "NVSReadSettings",              2000000,         0,   8000000,        0 },
+  { "PhaseScheduleCompile",         1500000,         0,   5000000,        0 },
+};
+#else
+#if !defined(__OPTIMIZE__) || defined(__OPTIMIZE_SIZE__)
+#error "the host limits are measured at -O2, build with 'env:bench_native'"
+#endif
+// host build (x86-64) at -O2, times of the benchmark thread only (the other tasks share the CPU there),
+// measured with 20 runs on a shared CI machine: medians 2..3 times the largest median, 99th percentiles
+// 4 times the median 99th percentile (at least 20 us); single stalls of the machine still reach ~0.3 ms
+// in the thread time, so a case above its limits is measured again ('BenchmarkAttempts')
+const BenchmarkLimit BenchmarkLimits[] = {
+  // case                      median base  per pixel   p99 base  per pixel
+  { "LEDRenderer/CurveUpdate",         1000,        80,     20000,      100 },
+  { "LEDRenderer/Render",              1000,        20,     20000,       40 },
+  { "LEDColorControl",                 5000,         0,     50000,        0 },
+  { "LEDStripShowFrames",              3000,         0,     20000,        0 },
+  { "MQTTCallback/LEDBrightness",     30000,         0,    120000,        0 },
+  { "MQTTCallback/LEDColorTop",       30000,         0,    120000,        0 },
+  { "MQTTCallback/Config",            30000,         0,    120000,        0 },
+  { "MQTTCallback/Unknown",            2000,         0,     20000,        0 },
+  { "NVSReadSettings",                 3000,         0,     25000,        0 },
+  { "PhaseScheduleCompile",           50000,         0,    150000,        0 },
+};
+#endif
+
+const int BenchmarkLimitCount = sizeof(BenchmarkLimits) / sizeof(BenchmarkLimits[0]);
@@ -0,0 +1,70 @@
+// -------------------------------------------------------------------
+// Connection manager - non-blocking state machine for WiFi, NTP and MQTT
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+// connection states, passed through in this order
+enum ConnectionState : uint8_t {
+  ConnectionIdle,
+  ConnectionWiFiConnecting, // 'WiFiBegin' called, waiting for an IP address
+  ConnectionNTPSyncing,     // 'NTPBegin' called, waiting for the system time
+  ConnectionMQTTConnecting, // one connection attempt per update
+  ConnectionOnline,         // everything connected, watching the MQTT session
+  ConnectionBackoff         // waiting before 'RetryState' is entered again
+};
+
+// actions and queries of the connections (real devices or host stand-ins)
+struct ConnectionHooks {
+  void (*WiFiBegin)();
+  void (*NTPBegin)();
+  bool (*NTPIsSynced)();
+  bool (*MQTTConnect)();
+  bool (*MQTTIsConnected)();
+  void (*Online)();          // called each time all connections are established
+};
+
+// timeouts and backoff of the connection attempts
+struct ConnectionTimings {
+  uint32_t WiFiTimeoutMillis;
+  uint32_t NTPTimeoutMillis;
+  uint32_t BackoffMinMillis;
+  uint32_t BackoffMaxMillis;
+  uint8_t BackoffJitterPercent;   // each delay is shortened by a random 0..n %, devices restarted together spread out
+};
+
+struct Connection {
+  ConnectionState State = ConnectionIdle;
+  ConnectionState RetryState = ConnectionIdle;
+  uint32_t StateMillis = 0;       // time the state was entered
+  uint32_t WaitMillis = 0;        // timeout or backoff delay of the state
+  uint8_t Attempts = 0;           // failed attempts in a row, base of the backoff
+  volatile bool isWiFiConnected = false; // written by the WiFi events
+  bool isTimeSynced = false;
+  uint32_t ReconnectCount = 0;
+  uint32_t JitterState = 1;       // random state of the backoff jitter (seed != 0)
+};
+
+// system times up to this Unix time (2020-09-13) are the clock counting from 1970 since the start, the
+// time was never set
+const time_t ConnectionValidEpoch = 1600000000;
+
+// Connection manager - true if the system time 'Now' was set (NTP), not counting from 1970
+inline bool ConnectionTimeIsValid(time_t Now) {
+  return Now > ConnectionValidEpoch;
+}
+
+// Connection manager - WiFi event (got IP / disconnected), safe to call from the WiFi task
+void ConnectionNotifyWiFi(Connection& Link, bool isConnected);
+
+// Connection manager - backoff delay after 'Attempts' failed attempts (without jitter)
+uint32_t ConnectionBackoffMillis(const ConnectionTimings& Timings, uint8_t Attempts);
+
+// Connection manager - backoff delay with jitter, advances the random state of 'Link'
+uint32_t ConnectionJitterMillis(Connection& Link, const ConnectionTimings& Timings, uint32_t Delay);
+
+// Connection manager - advance the state machine, never blocks (except for one 'MQTTConnect')
+void ConnectionUpdate(Connection& Link, const ConnectionHooks& Hooks, const ConnectionTimings& Timings, uint32_t Now);
@@ -0,0 +1,68 @@
+// -------------------------------------------------------------------
+// Diagnostics - runtime counters, published periodically as JSON ('-D DIAGNOSTICS=1')
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 'DIAGNOSTICS' 0 removes all counters and the publication, the hooks below expand to nothing
+#ifndef DIAGNOSTICS
+#define DIAGNOSTICS 0
+#endif
+
+#if DIAGNOSTICS
+
+#include <Arduino.h>
+#include <atomic>
+
+// counters with exactly one writer each: loop and MQTT values by 'loop()', render values by the
+// render task; relaxed loads and stores only (no read-modify-write), so they cost a few instructions
+struct DiagnosticsCounters {
+  std::atomic<uint32_t> LoopCount{0};           // 'loop()' iterations since the last report
+  std::atomic<uint32_t> MQTTLoopCount{0};       // 'mqttClient.loop()' calls since the last report
+  std::atomic<uint32_t> MQTTLoopTotalMicros{0};
+  std::atomic<uint32_t> MQTTLoopMaxMicros{0};
+  std::atomic<uint32_t> RenderCount{0};         // renders since the start
+  std::atomic<uint32_t> RenderMicros{0};        // duration of the last render (incl. strip output)
+  std::atomic<uint32_t> ShowSkipCount{0};       // renders without output (frame unchanged) since the start
+};
+extern DiagnosticsCounters Diagnostics;
+
+// Diagnostics - add to a counter of its only writer
+static inline void DiagnosticsAdd(std::atomic<uint32_t>& Counter, uint32_t Value) {
+  Counter.store(Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+}
+
+// Diagnostics - one 'mqttClient.loop()' took 'Micros'
+static inline void DiagnosticsMQTTLoop(uint32_t Micros) {
+  DiagnosticsAdd(Diagnostics.MQTTLoopCount, 1);
+  DiagnosticsAdd(Diagnostics.MQTTLoopTotalMicros, Micros);
+  if (Micros > Diagnostics.MQTTLoopMaxMicros.load(std::memory_order_relaxed)) {
+    Diagnostics.MQTTLoopMaxMicros.store(Micros, std::memory_order_relaxed);
+  }
+}
+
+// Diagnostics - one frame was rendered and shown within 'Micros'
+static inline void DiagnosticsRender(uint32_t Micros) {
+  DiagnosticsAdd(Diagnostics.RenderCount, 1);
+  Diagnostics.RenderMicros.store(Micros, std::memory_order_relaxed);
+}
+
+// Diagnostics - format the report as JSON and start the next interval (caller: 'loop()'), returns
+// the length or -1 if the buffer is too small
+int DiagnosticsFormat(char* Buffer, size_t Size, uint32_t Now, uint32_t NVSWriteCount, uint32_t ReconnectCount);
+
+#define DIAGNOSTICS_LOOP() DiagnosticsAdd(Diagnostics.LoopCount, 1)
+#define DIAGNOSTICS_START(Name) uint32_t Name = micros()
+#define DIAGNOSTICS_MQTT_LOOP(Start) DiagnosticsMQTTLoop(micros() - (Start))
+#define DIAGNOSTICS_RENDER(Start) DiagnosticsRender(micros() - (Start))
+#define DIAGNOSTICS_SHOW_SKIPPED() DiagnosticsAdd(Diagnostics.ShowSkipCount, 1)
+#else
+#define DIAGNOSTICS_LOOP() do { } while (0)
+#define DIAGNOSTICS_START(Name) do { } while (0)
+#define DIAGNOSTICS_MQTT_LOOP(Start) do { } while (0)
+#define DIAGNOSTICS_RENDER(Start) do { } while (0)
+#define DIAGNOSTICS_SHOW_SKIPPED() do { } while (0)
+#endif
@@ -0,0 +1,59 @@
+// -------------------------------------------------------------------
+// Event loop - the network/config task sleeps on an event group, automatic light sleep while idle
+// ('-D EVENT_LOOP=1')
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// 'EVENT_LOOP' 0 keeps 'loop()' spinning without waiting (no event group, no light sleep)
+#ifndef EVENT_LOOP
+#define EVENT_LOOP 0
+#endif
+
+// events that end the wait of 'loop()'
+const uint32_t EventLoopNetwork = 0x01; // data on the MQTT socket
+const uint32_t EventLoopPhase   = 0x02; // phase timer (next transition or midnight)
+const uint32_t EventLoopWake    = 0x04; // anything else that has work for 'loop()' (e.g. WiFi events)
+
+#if EVENT_LOOP
+
+// time spent by 'loop()' working and waiting (written and read by 'loop()'), and by the render
+// task holding the frame lock (no light sleep while frames are output)
+struct EventLoopStats {
+  bool isLightSleep = false;      // automatic light sleep is configured
+  uint64_t ActiveMicros = 0;      // 'loop()' between two waits
+  uint64_t IdleMicros = 0;        // 'loop()' waiting for events
+  uint32_t Wakeups = 0;           // waits ended by an event
+  std::atomic<uint32_t> FrameLockMillis{0}; // render task (frames, dithering, cross-fades), completed holds
+};
+extern EventLoopStats EventLoop;
+
+// Event loop - create the event group and the socket watcher, enable automatic light sleep
+// ('isLightSleep'), returns true if light sleep is active
+bool EventLoopBegin(bool isLightSleep, uint32_t WatcherStackSize, uint32_t WatcherPriority, int WatcherCore);
+
+// Event loop - signal events to 'loop()' (any task or timer callback)
+void EventLoopSet(uint32_t Events);
+
+// Event loop - wait for events at most 'TimeoutMillis', returns the events (0 = timeout)
+uint32_t EventLoopWait(uint32_t TimeoutMillis);
+
+// Event loop - MQTT socket to watch (-1 = none), and the data of the last signal was read
+void EventLoopWatchSocket(int Socket);
+void EventLoopSocketRead();
+
+// Event loop - the render task outputs frames ('isActive') or goes idle, light sleep is
+// blocked while frames are output, so the parallel DMA transfer is never cut
+void EventLoopFrameLock(bool isActive);
+
+// Event loop - time the frame lock was held since the start, including the current hold up to 'Now'
+uint32_t EventLoopFrameLockTotal(uint32_t Now);
+
+#else
+// the signals of other tasks cost nothing without the event loop
+static inline void EventLoopSet(uint32_t Events) {}
+static inline void EventLoopFrameLock(bool isActive) {}
+#endif
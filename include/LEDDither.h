@@ -0,0 +1,70 @@
+// -------------------------------------------------------------------
+// LED dither - temporal dithering of the 8.8 frame channels to the 8 bits of the strip
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <LEDGradient.h>
+
+// 8-bit RGBW pixel as sent to the strip
+struct LEDPixelOutput {
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+  uint8_t W;
+};
+
+// residual fraction of every channel of one strip (first-order delta-sigma), carried from frame
+// to frame so that the average output over a few frames equals the 8.8 value
+struct LEDDitherState {
+  uint8_t Error[LEDCurveMaxPixels][4];
+};
+
+// LED dither - start values of the residuals, spread over the pixels so that neighbouring pixels
+// do not toggle in the same frame
+void LEDDitherReset(LEDDitherState& State);
+
+// LED dither - one channel, returns the 8-bit output and keeps the residual fraction
+inline uint8_t LEDDitherChannel(uint16_t Value, uint8_t& Error) {
+  uint32_t Sum = (uint32_t)Value + Error;
+  uint32_t Output = Sum >> LEDChannelFractionBits;
+  if (Output > 255) {
+    Error = 0;
+    return 255;
+  }
+  Error = (uint8_t)Sum;
+  return (uint8_t)Output;
+}
+
+// LED dither - one channel rounded to 8 bits
+inline uint8_t LEDDitherRoundChannel(uint16_t Value) {
+  uint32_t Rounded = ((uint32_t)Value + (1 << (LEDChannelFractionBits - 1))) >> LEDChannelFractionBits;
+  return Rounded > 255 ? 255 : (uint8_t)Rounded;
+}
+
+// LED dither - one pixel, channels below 'Limit' (8.8) are dithered and brighter ones rounded (one
+// step is hardly visible there), returns true if a dithered channel has a fraction (the frame needs refreshes)
+inline bool LEDDitherPixel(const LEDPixel& Pixel, uint8_t* Error, LEDPixelOutput& Output, uint16_t Limit) {
+  bool hasFraction = false;
+  // internal lambda function for one channel
+  auto Channel = [&](uint16_t Value, uint8_t& ChannelError) -> uint8_t {
+    if (Value >= Limit) {
+      return LEDDitherRoundChannel(Value);
+    }
+    hasFraction |= (Value & 0xFF) != 0;
+    return LEDDitherChannel(Value, ChannelError);
+  };
+  Output.R = Channel(Pixel.R, Error[0]);
+  Output.G = Channel(Pixel.G, Error[1]);
+  Output.B = Channel(Pixel.B, Error[2]);
+  Output.W = Channel(Pixel.W, Error[3]);
+  return hasFraction;
+}
+
+// LED dither - one pixel rounded to 8 bits without dithering
+inline void LEDDitherRound(const LEDPixel& Pixel, LEDPixelOutput& Output) {
+  Output.R = LEDDitherRoundChannel(Pixel.R);
+  Output.G = LEDDitherRoundChannel(Pixel.G);
+  Output.B = LEDDitherRoundChannel(Pixel.B);
+  Output.W = LEDDitherRoundChannel(Pixel.W);
+}
@@ -0,0 +1,75 @@
+// -------------------------------------------------------------------
+// LED gradient - curve engine and frame buffer
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// maximum number of pixels a curve table can hold
+const int LEDCurveMaxPixels = 144;
+
+// maximum number of strips driven in parallel (channels of the I2S X8 output)
+const int LEDStripMaxCount = 8;
+
+// one LED strip: output pin, pixel count and gradient profile
+struct LEDStripConfig {
+  uint8_t Pin;
+  uint16_t PixelCount;
+  uint8_t BrightnessPercent; // scales 'LEDBrightness' for this strip
+  uint16_t TauPercent;       // scales 'LEDTauThousand' (e.g. PixelCount / 41 * 100 keeps the shape of 41 pixels)
+  bool isReversed;           // pixel 0 is the top end (strip mounted upside down)
+};
+
+// fixed-point format of the curve table: Q16 (1.0 = 65536)
+const int LEDCurveFractionBits = 16;
+const int32_t LEDCurveOne = (int32_t)1 << LEDCurveFractionBits;
+
+// precomputed 'LEDAmplifierY' for every pixel, rebuilt only when one of
+// 'PixelCount', 'Amplifier' or 'TauThousand' changes ('LEDRenderer<>::CurveUpdate()')
+struct LEDCurveTable {
+  int PixelCount = 0;
+  int Amplifier = 0;
+  int TauThousand = 0;
+  bool isValid = false;
+  int32_t Y[LEDCurveMaxPixels];
+};
+
+// LED gradient - exponential share of 'LEDAmplifierY' (fast for 'Amplifier' >= 0, slow below) for pixel 1..PixelCount
+double LEDCurveShape(int Pixel, int PixelCount, int Amplifier, int TauThousand);
+
+// LED gradient - reference value of 'LEDAmplifierY' in double precision for pixel 1..PixelCount
+double LEDCurveReference(int Pixel, int PixelCount, int Amplifier, int TauThousand);
+
+// fixed-point format of the frame channels: 8.8 (full intensity 255 = 0xFF00), reduced to the
+// 8 bits of the strip by temporal dithering
+const int LEDChannelFractionBits = 8;
+const int32_t LEDChannelOne = (int32_t)1 << LEDChannelFractionBits;
+const int32_t LEDChannelMax = 255 << LEDChannelFractionBits;
+
+// LED gradient - color of one channel (8.8) between 'Bottom' (Y = 0) and 'Top' (Y = 1), limited to
+// 0..LEDChannelMax ('Y' is reduced to Q15, so that the product fits into 32 bits)
+inline int LEDCurveChannel(int Bottom, int Top, int32_t Y) {
+  int32_t Value = Bottom + (((int32_t)(Top - Bottom) * (Y >> 1)) >> (LEDCurveFractionBits - 1));
+  if (Value < 0) {
+    return 0;
+  }
+  return Value > LEDChannelMax ? LEDChannelMax : (int)Value;
+}
+
+// one RGBW pixel of a frame (8.8 per channel)
+struct LEDPixel {
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+  uint16_t W;
+};
+
+// retained frame with the computed RGBW pixels, base for 'LEDStrip'
+struct LEDFrame {
+  int PixelCount = 0;
+  LEDPixel Pixel[LEDCurveMaxPixels];
+};
+
+// LED frame - set all pixels to '0'
+void LEDFrameClear(LEDFrame& Frame, int PixelCount);
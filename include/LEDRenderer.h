@@ -0,0 +1,135 @@
+// -------------------------------------------------------------------
+// LED renderer - gradient render specialized for pixel count and color feature
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <LEDGradient.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// compile-time index list 0..N-1 (C++11 has no 'std::index_sequence')
+template <int... Index> struct LEDIndexList {};
+template <int Count, int... Index> struct LEDIndexRange : LEDIndexRange<Count - 1, Count - 1, Index...> {};
+template <int... Index> struct LEDIndexRange<0, Index...> {
+  typedef LEDIndexList<Index...> Type;
+};
+
+// color features (channels of a strip type), 'LEDStripColor' selects one for all strips
+struct LEDColorGrb {
+  static const bool hasWhite = false;
+};
+struct LEDColorGrbw {
+  static const bool hasWhite = true;
+};
+
+// LED renderer - linear share of 'LEDAmplifierY' in Q16, 0 for the first and 1 for the last pixel (rounded)
+constexpr int32_t LEDRampValue(int Pixel, int PixelCount) {
+  return PixelCount <= 1 ? 0 : (int32_t)(((int64_t)Pixel * LEDCurveOne * 2 + (PixelCount - 1)) / (2 * (PixelCount - 1)));
+}
+
+// linear ramp of 'PixelCount' pixels, generated by the compiler
+template <int PixelCount, typename List = typename LEDIndexRange<PixelCount>::Type> struct LEDLinearRamp;
+template <int PixelCount, int... Index> struct LEDLinearRamp<PixelCount, LEDIndexList<Index...>> {
+  static constexpr int32_t Y[PixelCount] = { LEDRampValue(Index, PixelCount)... };
+};
+template <int PixelCount, int... Index>
+constexpr int32_t LEDLinearRamp<PixelCount, LEDIndexList<Index...>>::Y[PixelCount];
+
+// gradient of one render: end colors after the brightness limit and white limit (8.8), curve parameters
+struct LEDGradientColors {
+  int BottomR;
+  int BottomG;
+  int BottomB;
+  int TopR;
+  int TopG;
+  int TopB;
+  int WLimit;
+  int Amplifier;
+  int TauThousand;
+};
+
+// LED renderer - all loops run over the compile-time 'PixelCount' (in tiles of four pixels), the
+// white channel is computed only if 'Color' has one
+template <int PixelCount, typename Color>
+struct LEDRenderer {
+  static_assert(PixelCount >= 1 && PixelCount <= LEDCurveMaxPixels, "pixel count out of range");
+
+  // LED renderer - rebuild the curve table if the parameters changed, 'LEDAmplifier' 0 is the
+  // linear ramp itself, otherwise both shares are added exactly and rounded once (the rounded
+  // ramp would add up to 1 LSB to the error)
+  static bool CurveUpdate(LEDCurveTable& Table, int Amplifier, int TauThousand) {
+    if (Table.isValid && Table.PixelCount == PixelCount &&
+        Table.Amplifier == Amplifier && Table.TauThousand == TauThousand) {
+      return false;
+    }
+    if (Amplifier == 0) {
+      memcpy(Table.Y, LEDLinearRamp<PixelCount>::Y, sizeof(int32_t) * PixelCount);
+    }
+    else {
+      int Share = abs(Amplifier);
+      Table.Y[0] = 0;
+      for (int i = 1; i < PixelCount - 1; ++i) {
+        double Shape = LEDCurveShape(i + 1, PixelCount, Amplifier, TauThousand);
+        double Linear = (double)i / (PixelCount - 1);
+        Table.Y[i] = static_cast<int32_t>(lround((Shape * Share + Linear * (100 - Share)) / 100 * LEDCurveOne));
+      }
+      // the last pixel shows the top color (a single pixel the bottom color)
+      Table.Y[PixelCount - 1] = PixelCount > 1 ? LEDCurveOne : 0;
+    }
+    Table.PixelCount = PixelCount;
+    Table.Amplifier = Amplifier;
+    Table.TauThousand = TauThousand;
+    Table.isValid = true;
+    return true;
+  }
+
+  // LED renderer - curve table, R/G/B of the gradient and the balanced white in one frame
+  static void Render(LEDFrame& Frame, LEDCurveTable& Curve, const LEDGradientColors& Gradient) {
+    CurveUpdate(Curve, Gradient.Amplifier, Gradient.TauThousand);
+    Frame.PixelCount = PixelCount;
+    int WMax = 0;
+    // internal lambda function for one pixel, returns the average of R/G/B
+    auto RenderPixel = [&](int i) -> int {
+      LEDPixel& Pixel = Frame.Pixel[i];
+      int32_t Y = Curve.Y[i];
+      Pixel.R = LEDCurveChannel(Gradient.BottomR, Gradient.TopR, Y);
+      Pixel.G = LEDCurveChannel(Gradient.BottomG, Gradient.TopG, Y);
+      Pixel.B = LEDCurveChannel(Gradient.BottomB, Gradient.TopB, Y);
+      Pixel.W = 0;
+      return Color::hasWhite ? (Pixel.R + Pixel.G + Pixel.B) / 3 : 0;
+    };
+    const int TileEnd = PixelCount - PixelCount % 4;
+    for (int i = 0; i < TileEnd; i += 4) {
+      int A0 = RenderPixel(i);
+      int A1 = RenderPixel(i + 1);
+      int A2 = RenderPixel(i + 2);
+      int A3 = RenderPixel(i + 3);
+      if (Color::hasWhite) {
+        int A01 = A0 > A1 ? A0 : A1;
+        int A23 = A2 > A3 ? A2 : A3;
+        int A = A01 > A23 ? A01 : A23;
+        WMax = A > WMax ? A : WMax;
+      }
+    }
+    for (int i = TileEnd; i < PixelCount; ++i) {
+      int A = RenderPixel(i);
+      WMax = A > WMax ? A : WMax;
+    }
+    if (Color::hasWhite && WMax > 0) {
+      // white of every pixel in proportion to its R/G/B average, 'WMax' reaches 'WLimit'
+      for (int j = 0; j < PixelCount; ++j) {
+        LEDPixel& Pixel = Frame.Pixel[j];
+        uint32_t W = (uint32_t)((Pixel.R + Pixel.G + Pixel.B) / 3) * (uint32_t)Gradient.WLimit / (uint32_t)WMax;
+        Pixel.W = W > (uint32_t)LEDChannelMax ? LEDChannelMax : W;
+      }
+    }
+  }
+
+  // LED renderer - all pixels off
+  static void Clear(LEDFrame& Frame) {
+    Frame.PixelCount = PixelCount;
+    memset(Frame.Pixel, 0, sizeof(LEDPixel) * PixelCount);
+  }
+};
@@ -0,0 +1,28 @@
+// -------------------------------------------------------------------
+// LED transition - non-blocking cross-fade between two frames
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <LEDGradient.h>
+
+// cross-fade from the frame shown before to a target frame
+struct LEDTransition {
+  LEDFrame From;
+  LEDFrame To;
+  uint32_t StartMillis = 0;
+  uint32_t DurationMillis = 0;
+  uint32_t LastFrameMillis = 0;
+  bool isActive = false;
+};
+
+// LED frame - integer lerp of every channel, 'Weight' 0..LEDCurveOne = 'From'..'To'
+void LEDFrameLerp(LEDFrame& Frame, const LEDFrame& From, const LEDFrame& To, int32_t Weight);
+
+// LED transition - start a cross-fade from 'From' to 'To' at time 'Now' (ms)
+void LEDTransitionStart(LEDTransition& Transition, const LEDFrame& From, const LEDFrame& To,
+                        uint32_t Now, uint32_t DurationMillis);
+
+// LED transition - compute the next frame if 'FrameMillis' elapsed since the last one,
+// returns true if 'Frame' was updated (the last frame equals the target and ends the transition)
+bool LEDTransitionStep(LEDTransition& Transition, LEDFrame& Frame, uint32_t Now, uint32_t FrameMillis);
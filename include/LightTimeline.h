@@ -0,0 +1,60 @@
+// -------------------------------------------------------------------
+// Light timeline - keyframes with a full LED parameter set per day
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// values of a light scene (same order as in a 'Timeline' message)
+enum LightSceneValue {
+  LightStatus,        // 0: Lights Off; 1: Lights ON (not interpolated)
+  LightBrightness,    // 0..100
+  LightAmplifier,     // -100..100
+  LightTauThousand,   // 1..32767
+  LightColorTopR,     // 0..255
+  LightColorTopG,
+  LightColorTopB,
+  LightColorBottomR,
+  LightColorBottomG,
+  LightColorBottomB,
+  LightColorWhite,    // 0..100
+  LightSceneValueCount
+};
+
+// maximum number of keyframes per day
+const int LightTimelineMaxKeyframes = 16;
+
+// complete LED parameter set
+struct LightScene {
+  int16_t Value[LightSceneValueCount];
+};
+
+// scene that becomes active at 'Minute' of the day (0..1439)
+struct LightKeyframe {
+  uint16_t Minute;
+  LightScene Scene;
+};
+
+// keyframes sorted by 'Minute', the last keyframe continues into the next day
+struct LightTimeline {
+  uint8_t Count = 0;
+  LightKeyframe Keyframe[LightTimelineMaxKeyframes];
+};
+
+// Light timeline - index of the keyframe active at 'Minute' (binary search), -1 if empty
+int LightTimelineFind(const LightTimeline& Timeline, int Minute);
+
+// Light timeline - interpolated scene at 'Second' of the day (0..86399), false if empty
+bool LightTimelineEvaluate(const LightTimeline& Timeline, int32_t Second, LightScene& Scene);
+
+// Light timeline - parse "H:MM,v1,..,v11;H:MM,.." (empty = no keyframes), false on invalid input
+bool LightTimelineParse(const char* Message, unsigned int MessageLength, LightTimeline& Timeline);
+
+// Light timeline - format as 'Timeline' message, returns the length without terminator
+int LightTimelineFormat(const LightTimeline& Timeline, char* Buffer, int BufferSize);
+
+// Light timeline - number of bytes to persist (header and used keyframes)
+inline unsigned int LightTimelineStoredSize(uint8_t Count) {
+  return sizeof(LightTimeline) - sizeof(LightKeyframe) * (LightTimelineMaxKeyframes - Count);
+}
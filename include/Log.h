@@ -0,0 +1,73 @@
+// -------------------------------------------------------------------
+// Log - level-filtered logging over a lock-free ring buffer
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// log levels, 'LOG_LEVEL' selects the highest level that is compiled in, the calls of all other
+// levels are still type-checked but removed by the compiler
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// trace categories (bit mask), 'LOG_TRACE_CATEGORIES' selects the compiled-in ones
+#define LOG_CATEGORY_PIXEL 0x01 // RGBW values of every pixel per render
+
+#ifndef LOG_TRACE_CATEGORIES
+#define LOG_TRACE_CATEGORIES 0
+#endif
+
+// number of lines in the ring buffer (power of two) and maximum length of one line
+const uint32_t LogRingSize = 64;
+const int LogLineSize = 96;
+
+// Log - start the task that writes the buffered lines to the serial interface
+void LogBegin(uint32_t StackSize, uint32_t Priority, int Core);
+
+// Log - format one line into the ring buffer (never waits, the line is dropped if the buffer is full)
+void LogWrite(const char* Format, ...) __attribute__((format(printf, 1, 2)));
+
+// Log - write all buffered lines to the serial interface, returns the number of lines
+int LogFlush();
+
+// Log - number of lines dropped since the start because the buffer was full
+uint32_t LogDroppedCount();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LogWrite(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { if (0) { LogWrite(__VA_ARGS__); } } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LogWrite(__VA_ARGS__)
+#else
+#define LOG_WARN(...) do { if (0) { LogWrite(__VA_ARGS__); } } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LogWrite(__VA_ARGS__)
+#else
+#define LOG_INFO(...) do { if (0) { LogWrite(__VA_ARGS__); } } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LogWrite(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { if (0) { LogWrite(__VA_ARGS__); } } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_TRACE
+#define LOG_TRACE(Category, ...) do { if ((LOG_TRACE_CATEGORIES) & (Category)) { LogWrite(__VA_ARGS__); } } while (0)
+#else
+#define LOG_TRACE(Category, ...) do { if (0) { LogWrite(__VA_ARGS__); } } while (0)
+#endif
@@ -0,0 +1,30 @@
+// -------------------------------------------------------------------
+// MQTT queue - outgoing messages kept while the session is down, sent in order afterwards
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// size of the ring buffer (multiple of 8), the oldest messages are dropped when it is full
+const uint32_t MQTTQueueBytes = 4096;
+
+// records of header, topic name (terminated) and payload, padded to 8 bytes so a record never
+// wraps and can be published straight from the buffer
+struct MQTTQueue {
+  uint8_t Buffer[MQTTQueueBytes];
+  uint32_t Head = 0;         // oldest record
+  uint32_t Tail = 0;         // behind the newest record
+  uint16_t Count = 0;        // queued messages
+  uint32_t DroppedCount = 0; // messages dropped since the start (queue full)
+};
+
+// MQTT queue - append a message, drops the oldest ones until it fits, false if it can never fit
+bool MQTTQueuePush(MQTTQueue& Queue, const char* TopicName, const uint8_t* Payload, uint16_t Length, bool isRetained);
+
+// MQTT queue - oldest message (pointers into the buffer, valid until the next push/pop), false if empty
+bool MQTTQueueFront(const MQTTQueue& Queue, const char*& TopicName, const uint8_t*& Payload, uint16_t& Length,
+                    bool& isRetained);
+
+// MQTT queue - remove the oldest message
+void MQTTQueuePop(MQTTQueue& Queue);
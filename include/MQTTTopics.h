@@ -0,0 +1,93 @@
+// -------------------------------------------------------------------
+// MQTT topics - registry of all topics, dispatch and value parsing
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// kinds of topic values, each kind has one parser and one formatter
+enum MQTTTopicKind : uint8_t {
+  MQTTTopicTime,      // "H:MM", settings 'Index' (hours) and 'Index + 1' (minutes)
+  MQTTTopicSetting,   // integer, settings 'Index'
+  MQTTTopicScene,     // integer, scene value 'Index' of the active time phase
+  MQTTTopicColor,     // "[  R,  G,  B]", scene values 'Index'..'Index + 2' of the active time phase
+  MQTTTopicPhase,     // integer, active time phase
+  MQTTTopicTimeline,  // keyframes, see 'LightTimelineParse'
+  MQTTTopicSchedule,  // weekday/date rules of the time phase, see 'PhaseRulesParse'
+  MQTTTopicConfig,    // batch "Name=Value;Name=Value;..", see 'MQTTConfigParse'
+  MQTTTopicState,     // snapshot "Name=Value;Name=Value;.." of all other published values
+  MQTTTopicCommand    // no value, 'Index' selects the command
+};
+
+// direction of a topic
+const uint8_t MQTTTopicSubscribe = 0x01;
+const uint8_t MQTTTopicPublish   = 0x02;
+
+// maximum number of integers of one topic value ('MQTTTopicColor')
+const int MQTTTopicMaxValues = 3;
+
+// one row of the topic registry
+struct MQTTTopic {
+  const char* Name;
+  MQTTTopicKind Kind;
+  uint8_t Flags;      // 'MQTTTopicSubscribe' and/or 'MQTTTopicPublish'
+  uint8_t Index;      // 'SettingsIndex', 'LightSceneValue' or command, depending on 'Kind'
+  int16_t Min;        // valid range of every integer
+  int16_t Max;
+};
+
+// hash index over the registry (open addressing), built once at startup
+const int MQTTTopicSlots = 64; // power of two, at least twice the number of topics
+struct MQTTTopicIndex {
+  const MQTTTopic* Topics = nullptr;
+  int Count = 0;
+  int8_t Slot[MQTTTopicSlots];
+};
+
+// MQTT topics - build the hash index of 'Count' topics, false if there are too many
+bool MQTTTopicIndexBuild(MQTTTopicIndex& Index, const MQTTTopic* Topics, int Count);
+
+// MQTT topics - registry row of 'TopicName', nullptr if unknown
+const MQTTTopic* MQTTTopicFind(const MQTTTopicIndex& Index, const char* TopicName);
+
+// MQTT topics - registry row of the first 'Length' characters of 'TopicName', nullptr if unknown
+const MQTTTopic* MQTTTopicFind(const MQTTTopicIndex& Index, const char* TopicName, size_t Length);
+
+// MQTT topics - rest of 'TopicPath' behind "<Prefix>/" (the registry name of a received topic),
+// nullptr if the topic lies outside of 'Prefix' or has no rest
+const char* MQTTTopicSuffix(const char* TopicPath, const char* Prefix);
+
+// MQTT topics - split an optional apply time "@<UnixMillis>|" off the front of a command message,
+// 'ApplyAtMillis' is 0 without one and 'Offset' is the start of the message behind it, false on an
+// invalid envelope
+bool MQTTEnvelopeParse(const char* Message, unsigned int MessageLength, int64_t& ApplyAtMillis, unsigned int& Offset);
+
+// MQTT topics - number of integers of a topic value
+int MQTTTopicValueCount(MQTTTopicKind Kind);
+
+// MQTT topics - parse and validate a message into 'Values', false on invalid input
+bool MQTTTopicParse(const MQTTTopic& Topic, const char* Message, unsigned int MessageLength, int* Values);
+
+// MQTT topics - format 'Values' as message text, returns the text length
+int MQTTTopicFormat(const MQTTTopic& Topic, const int* Values, char* Buffer, size_t BufferSize);
+
+// MQTT topics - append "Name=Value" (with ';' if 'Length' > 0) to the text in 'Buffer', returns the
+// new text length, a field that does not fit completely is left out
+size_t MQTTStateAppend(char* Buffer, size_t BufferSize, size_t Length, const MQTTTopic& Topic, const int* Values);
+
+// maximum number of fields of one configuration batch
+const int MQTTConfigMaxFields = 16;
+
+// one validated field of a configuration batch
+struct MQTTConfigField {
+  const MQTTTopic* Topic;
+  int Value[MQTTTopicMaxValues];
+};
+
+// MQTT topics - parse and validate a configuration batch "Name=Value;Name=Value;.." (names of
+// subscribed topics with values, separated by ';' or line breaks), a repeated name replaces the
+// earlier value, returns the number of fields or -1 if any field is invalid
+int MQTTConfigParse(const MQTTTopicIndex& Index, const char* Message, unsigned int MessageLength,
+                    MQTTConfigField* Fields, int MaxFields);
@@ -0,0 +1,30 @@
+// -------------------------------------------------------------------
+// Parse integer - bounded integer reader shared by the message parsers (MQTT topics, light
+// timeline, phase schedule)
+// -------------------------------------------------------------------
+
+#pragma once
+
+// Parse integer - read an integer of at most 'MaxDigits' digits at position 'i', with 'isSigned' a
+// leading '-' is part of it, false if there is none or it is longer ('i' is then undefined)
+inline bool ParseInteger(const char* Message, unsigned int MessageLength, unsigned int& i, int MaxDigits,
+                         bool isSigned, int& Value) {
+  bool isNegative = false;
+  int Digits = 0;
+  Value = 0;
+  if (isSigned && i < MessageLength && Message[i] == '-') {
+    isNegative = true;
+    i++;
+  }
+  while (i < MessageLength && Message[i] >= '0' && Message[i] <= '9') {
+    if (++Digits > MaxDigits) {
+      return false;
+    }
+    Value = Value * 10 + (Message[i] - '0');
+    i++;
+  }
+  if (isNegative) {
+    Value = -Value;
+  }
+  return Digits > 0;
+}
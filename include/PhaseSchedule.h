@@ -0,0 +1,81 @@
+// -------------------------------------------------------------------
+// Phase schedule - day/night phase with weekday and date rules, precomputed transitions
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+// maximum number of rules ('Schedule' message)
+const int PhaseMaxRules = 8;
+
+// override of the start times on some weekdays and/or within a date range
+struct PhaseRule {
+  uint32_t FirstDate;   // YYYYMMDD, year 0 = every year (MMDD), 0 = no date range
+  uint32_t LastDate;    // YYYYMMDD (inclusive), a yearly range may continue into the next year
+  uint16_t DayMinute;   // start of the daytime (minute of the day)
+  uint16_t NightMinute; // start of the nighttime (minute of the day)
+  uint8_t WeekdayMask;  // bit 0 = Sunday .. bit 6 = Saturday ('tm_wday')
+  uint8_t Reserved[3];
+};
+
+// rules in the order of the message, the last matching rule of a day wins, days without
+// a matching rule use the start times of 'StartTimeDay'/'StartTimeNight'
+struct PhaseRules {
+  uint8_t Count = 0;
+  PhaseRule Rule[PhaseMaxRules];
+};
+
+// start of a phase at a wall-clock time
+struct PhaseTransition {
+  time_t Time;
+  bool isDayPhase;
+};
+
+// transitions of the current and the next day (at most three per day: midnight, day and night start)
+const int PhaseMaxTransitions = 6;
+
+// phase now, the pending transitions and the monotonic time ('esp_timer_get_time()') of the next
+// transition or day rollover, at the rollover one more day is compiled (the list covers >= 24 h)
+struct PhaseSchedule {
+  bool isValid = false;
+  bool isDayPhase = false;
+  int64_t DeadlineMicros = 0;
+  uint8_t Count = 0;                          // pending transitions, sorted by time
+  PhaseTransition Transition[PhaseMaxTransitions];
+  time_t LastDayStart = 0;                    // start of the last compiled day (rollover time)
+  time_t CompiledUntil = 0;                   // end of the last compiled day
+  bool isDayPhaseAtEnd = false;               // phase at 'CompiledUntil'
+  uint32_t CompiledDays = 0;                  // days compiled since start (full and incremental)
+};
+
+// Phase schedule - day phase at 'Minute' of the day for the start times of day and night (minutes of the day)
+bool PhaseIsDay(int DayMinute, int NightMinute, int Minute);
+
+// Phase schedule - start times of the day 'Local' (date fields), the last matching rule wins
+void PhaseStartTimes(const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute, const struct tm& Local,
+                     int& DayMinute, int& NightMinute);
+
+// Phase schedule - compile the transitions of the current and the next day at the wall-clock time 'Now',
+// 'Micros' is the monotonic time of 'Now'
+void PhaseScheduleCompile(PhaseSchedule& Schedule, const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute,
+                          time_t Now, int64_t Micros);
+
+// Phase schedule - take the transitions reached at 'Now', compile one more day after midnight and set the
+// next deadline, returns true if the phase changed
+bool PhaseScheduleAdvance(PhaseSchedule& Schedule, const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute,
+                          time_t Now, int64_t Micros);
+
+// Phase schedule - the transitions are no longer valid (start times or rules changed, system time set)
+inline void PhaseScheduleInvalidate(PhaseSchedule& Schedule) {
+  Schedule.isValid = false;
+}
+
+// Phase schedule - parse "Days,From,To,H:MM,H:MM;.." (empty = no rules), false on invalid input;
+// 'Days' are ISO weekdays ("12345" = Monday..Friday) or '*', 'From'/'To' are "MM-DD" (every year),
+// "YYYY-MM-DD" or both '*'
+bool PhaseRulesParse(const char* Message, unsigned int MessageLength, PhaseRules& Rules);
+
+// Phase schedule - format as 'Schedule' message, returns the length without terminator
+int PhaseRulesFormat(const PhaseRules& Rules, char* Buffer, int BufferSize);
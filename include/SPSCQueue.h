@@ -0,0 +1,41 @@
+// -------------------------------------------------------------------
+// SPSC queue - lock-free queue for one producer and one consumer task
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// 'Size' must be a power of two, one slot stays free to tell full from empty
+template <typename T, uint32_t Size>
+struct SPSCQueue {
+  static_assert((Size & (Size - 1)) == 0, "SPSCQueue size must be a power of two");
+
+  T Slot[Size];
+  std::atomic<uint32_t> Head{0}; // next slot to read, written by the consumer only
+  std::atomic<uint32_t> Tail{0}; // next slot to write, written by the producer only
+
+  // producer - append a copy of 'Item', false if the queue is full
+  bool Push(const T& Item) {
+    uint32_t CurrentTail = Tail.load(std::memory_order_relaxed);
+    uint32_t NextTail = (CurrentTail + 1) & (Size - 1);
+    if (NextTail == Head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    Slot[CurrentTail] = Item;
+    Tail.store(NextTail, std::memory_order_release);
+    return true;
+  }
+
+  // consumer - take the oldest item, false if the queue is empty
+  bool Pop(T& Item) {
+    uint32_t CurrentHead = Head.load(std::memory_order_relaxed);
+    if (CurrentHead == Tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    Item = Slot[CurrentHead];
+    Head.store((CurrentHead + 1) & (Size - 1), std::memory_order_release);
+    return true;
+  }
+};
@@ -2,27 +2,95 @@
 // General Settings
 // -------------------------------------------------------------------
 
-// WiFi status
-bool isConnecting = false;
+// light scene values and timeline
+#include <LightTimeline.h>
+// connection timings
+#include <ConnectionManager.h>
+// settings store (NVS)
+#include <SettingsStore.h>
+// MQTT topic registry
+#include <MQTTTopics.h>
+// LED strip configuration
+#include <LEDRenderer.h>
+
+// WiFi / NTP / MQTT - timeouts and backoff of the connection state machine
+const ConnectionTimings ConnectionTiming = {
+  10000,  // WiFi timeout (ms) until a new connection attempt
+  10000,  // NTP timeout (ms), afterwards MQTT is connected anyway
+  1000,   // first backoff (ms) after a failed attempt, doubled with each further one
+  60000,  // maximum backoff (ms)
+  50      // jitter (%), each backoff is shortened by a random 0..50 %
+};
 
 // MQTT - server settings
 const char* MQTTServer = "192.168.178.25";
 const int MQTTPort = 1883;
+const int MQTTSocketTimeoutSeconds = 3; // limits the blocking time of one connection attempt
+
+// MQTT - commands of 'MQTTTopicCommand' topics
+enum MQTTCommand : uint8_t {
+  MQTTCommandUpdate   // publish all settings
+};
+
+// MQTT - topic registry (names below the device prefix), dispatch and publishes are generated from this table
+const uint8_t MQTTTopicInOut = MQTTTopicSubscribe | MQTTTopicPublish;
+const MQTTTopic MQTTTopics[] = {
+  // name                kind               flags               index                     min    max
+  { "StartTimeDay",      MQTTTopicTime,     MQTTTopicInOut,     SettingStartTimeDayHours,   0,     0 },   // 1:5..13:9 = 01:05..13:09
+  { "StartTimeNight",    MQTTTopicTime,     MQTTTopicInOut,     SettingStartTimeNightHours, 0,     0 },   // 1:5..13:9 = 01:05..13:09
+  { "TimePhase",         MQTTTopicPhase,    MQTTTopicPublish,   0,                          0,     1 },   // 0: nighttime; 1: daytime
+  { "LEDStatus",         MQTTTopicScene,    MQTTTopicInOut,     LightStatus,                0,     1 },   // 0: Lights Off; 1: Lights ON
+  { "LEDBrightness",     MQTTTopicScene,    MQTTTopicInOut,     LightBrightness,            0,   100 },   // 0..100 = Lights off..full intensity
+  { "LEDAmplifier",      MQTTTopicScene,    MQTTTopicInOut,     LightAmplifier,          -100,   100 },   // -100..0..100 = slow..linear..fast
+  { "LEDTauThousand",    MQTTTopicScene,    MQTTTopicInOut,     LightTauThousand,           1, 32767 },   // 5125..8200 = 41 pxl / 8 periods * 1000..
+                                                                                                          //            ..41 pxl / 5 periods * 1000 =
+                                                                                                          //              faster increase..slower increase
+  { "LEDColorTop",       MQTTTopicColor,    MQTTTopicInOut,     LightColorTopR,             0,   255 },   // [  5, 55,255]
+  { "LEDColorBottom",    MQTTTopicColor,    MQTTTopicInOut,     LightColorBottomR,          0,   255 },   // [  5, 55,255]
+  { "LEDColorWhite",     MQTTTopicScene,    MQTTTopicInOut,     LightColorWhite,            0,   100 },   // 0..100 = white off..white full intensity
+  { "TransitionMinutes", MQTTTopicSetting,  MQTTTopicInOut,     SettingTransitionMinutes,   0,   120 },   // 0..120 = hard switch..minutes of day/night cross-fade
+  { "Timeline",          MQTTTopicTimeline, MQTTTopicInOut,     0,                          0,     0 },   // 7:00,1,10,0,5125,77,0,26,0,60,82,10;9:00,1,70,.. = keyframes
+                                                                                                          //   'H:MM,Status,Brightness,Amplifier,TauThousand,
+                                                                                                          //    TopR,TopG,TopB,BottomR,BottomG,BottomB,White',
+                                                                                                          //   empty = day/night settings
+  { "Schedule",          MQTTTopicSchedule, MQTTTopicInOut,     0,                          0,     0 },   // 67,*,*,10:00,23:00;*,12-24,12-26,10:00,23:30 = rules
+                                                                                                          //   'Days,From,To,DayStart,NightStart' (ISO weekdays or '*',
+                                                                                                          //    'MM-DD', 'YYYY-MM-DD' or '*'), the last matching rule wins,
+                                                                                                          //   empty = 'StartTimeDay'/'StartTimeNight' on all days
+  { "Config",            MQTTTopicConfig,   MQTTTopicSubscribe, 0,                          0,     0 },   // LEDBrightness=70;LEDColorTop=[  5, 55,255];.. = batch of the topics
+                                                                                                          //   above (without 'Timeline', 'Schedule'), applied together with one render
+  { "State",             MQTTTopicState,    MQTTTopicPublish,   0,                          0,     0 },   // StartTimeDay=9:00;..;LEDColorWhite=70;.. = retained snapshot of all
+                                                                                                          //   published values (without 'Timeline', 'Schedule'), remove to disable
+  { "Update",            MQTTTopicCommand,  MQTTTopicSubscribe, MQTTCommandUpdate,          0,     0 },   // 1 = update
+};
+const int MQTTTopicCount = sizeof(MQTTTopics) / sizeof(MQTTTopics[0]);
+
+// MQTT - publish one message per topic (changed values only, all values on 'Update'),
+//        'false' = the retained 'State' snapshot only
+const bool MQTTPublishTopicMessages = true;
+
+// MQTT - buffer size (incoming and outgoing messages, 'Timeline' needs up to ~800 bytes)
+const int MQTTBufferSize = 1024;
 
-// MQTT - subscribed topics
-const char* MQTTTopicStartTimeDay       = "StartTimeDay";   // 1:5..13:9 = 01:05..13:09
-const char* MQTTTopicStartTimeNight     = "StartTimeNight"; // 1:5..13:9 = 01:05..13:09
-const char* MQTTTopicTimePhase          = "TimePhase";      // 0: nighttime; 1: daytime
-const char* MQTTTopicLEDStatus          = "LEDStatus";      // 0: Lights ON; 1: Lights Off
-const char* MQTTTopicLEDBrightness      = "LEDBrightness";  // 0..100 = Lights off..full intensity
-const char* MQTTTopicLEDAmplifier       = "LEDAmplifier";   // -100..0..100 = slow..linear..fast
-const char* MQTTTopicLEDTauThousand     = "LEDTauThousand"; // 5125..8200 = 41 pxl / 8 periods * 1000..
-                                                            //            ..41 pxl / 5 periods * 1000 =
-                                                            //              faster increase..slower increase
-const char* MQTTTopicLEDColorTop        = "LEDColorTop";    // [  5, 55,255]
-const char* MQTTTopicLEDColorBottom     = "LEDColorBottom"; // [  5, 55,255]
-const char* MQTTTopicLEDColorWhite      = "LEDColorWhite";  // 0..100 = white off..white full intensity
-const char* MQTTTopicUpdate             = "Update";         // 1 = update
+// MQTT - topic namespace of this device, values are published to '<prefix>/<Name>' and commands are
+// received from '<prefix>/set/<Name>' (one wildcard subscription); the prefix is 'WiFiHostname', with
+// 'MQTTPrefixFromMAC' followed by the last three bytes of the MAC address (same image on many devices),
+// the client ID always carries the full MAC address, so devices never replace each other's session
+const bool MQTTPrefixFromMAC = false;
+const char* MQTTCommandLevel = "set";
+
+// MQTT - groups of this device, one publish to '<root>/<group>/set/<Name>' reaches every member (one
+// subscription per group); a message "@<UnixMillis>|<message>" (device or group topic) is applied by
+// every member at that NTP time, its frame is rendered on arrival and shown at the instant; no group
+// by default, list the groups in front of the closing 'nullptr', e.g. { "All", "Tank1", nullptr }
+const char* MQTTGroupRoot = "Group";
+const char* MQTTGroups[] = { nullptr };
+const int MQTTGroupCount = sizeof(MQTTGroups) / sizeof(MQTTGroups[0]) - 1;
+const uint32_t MQTTApplyMaxMillis = 60000; // apply times further ahead are refused (clock of the sender wrong)
+
+// MQTT - diagnostics ('-D DIAGNOSTICS=1'), published to '<prefix>/Diagnostics' in this interval
+const char* DiagnosticsTopicName = "Diagnostics";
+const uint32_t DiagnosticsIntervalMillis = 60000;
 
 // NTP - Server
 const char* NTPServer = "pool.ntp.org";
@@ -32,7 +100,10 @@ const int   daylightOffset_sec = 3600;
 // NVS - DB
 const char* NVSDBName = "NVSDB";
 
-// NVS - variable names
+// NVS - settings blob (all settings in one entry, see 'SettingsBlob')
+const char* NVSVarSettings = "Settings";
+
+// NVS - legacy variable names (one entry per setting, imported once into the settings blob)
 const char* NVSVarStartTimeDayHours     = "Value01";
 const char* NVSVarStartTimeDayMinutes   = "Value02";
 const char* NVSVarStartTimeNightHours   = "Value03";
@@ -59,6 +130,8 @@ const char* NVSVarLEDColorBottomNightG  = "Value23";
 const char* NVSVarLEDColorBottomNightB  = "Value24";
 const char* NVSVarLEDColorWhiteDay      = "Value25";
 const char* NVSVarLEDColorWhiteNight    = "Value26";
+const char* NVSVarTransitionMinutes     = "Value27";
+const char* NVSVarTimeline              = "Value28"; // binary, 'LightTimeline'
 
 // NVS - standard values
 int NVSStdStartTimeDayHours = 9;
@@ -87,10 +160,48 @@ int NVSStdLEDColorBottomNightG = 60;
 int NVSStdLEDColorBottomNightB = 82;
 int NVSStdLEDColorWhiteDay = 70;
 int NVSStdLEDColorWhiteNight = 30;
+int NVSStdTransitionMinutes = 30;
+
+// NVS - legacy variable names and standard values in the order of 'SettingsIndex'
+const SettingsField NVSFields[SettingCount] = {
+  { NVSVarStartTimeDayHours, NVSStdStartTimeDayHours },
+  { NVSVarStartTimeDayMinutes, NVSStdStartTimeDayMinutes },
+  { NVSVarStartTimeNightHours, NVSStdStartTimeNightHours },
+  { NVSVarStartTimeNightMinutes, NVSStdStartTimeNightMinutes },
+  { NVSVarTransitionMinutes, NVSStdTransitionMinutes },
+  // nighttime LED settings
+  { NVSVarLEDStatusNight, NVSStdLEDStatusNight },
+  { NVSVarLEDBrightnessNight, NVSStdLEDBrightnessNight },
+  { NVSVarLEDAmplifierNight, NVSStdLEDAmplifierNight },
+  { NVSVarLEDTauNight, NVSStdLEDTauNight },
+  { NVSVarLEDColorTopNightR, NVSStdLEDColorTopNightR },
+  { NVSVarLEDColorTopNightG, NVSStdLEDColorTopNightG },
+  { NVSVarLEDColorTopNightB, NVSStdLEDColorTopNightB },
+  { NVSVarLEDColorBottomNightR, NVSStdLEDColorBottomNightR },
+  { NVSVarLEDColorBottomNightG, NVSStdLEDColorBottomNightG },
+  { NVSVarLEDColorBottomNightB, NVSStdLEDColorBottomNightB },
+  { NVSVarLEDColorWhiteNight, NVSStdLEDColorWhiteNight },
+  // daytime LED settings
+  { NVSVarLEDStatusDay, NVSStdLEDStatusDay },
+  { NVSVarLEDBrightnessDay, NVSStdLEDBrightnessDay },
+  { NVSVarLEDAmplifierDay, NVSStdLEDAmplifierDay },
+  { NVSVarLEDTauDay, NVSStdLEDTauDay },
+  { NVSVarLEDColorTopDayR, NVSStdLEDColorTopDayR },
+  { NVSVarLEDColorTopDayG, NVSStdLEDColorTopDayG },
+  { NVSVarLEDColorTopDayB, NVSStdLEDColorTopDayB },
+  { NVSVarLEDColorBottomDayR, NVSStdLEDColorBottomDayR },
+  { NVSVarLEDColorBottomDayG, NVSStdLEDColorBottomDayG },
+  { NVSVarLEDColorBottomDayB, NVSStdLEDColorBottomDayB },
+  { NVSVarLEDColorWhiteDay, NVSStdLEDColorWhiteDay },
+};
+
+// NVS - commit changed settings after this quiet period, at the latest after the maximum delay
+const uint32_t NVSCommitQuietMillis = 2000;
+const uint32_t NVSCommitMaxDelayMillis = 30000;
 
 // Timer
-float StartTimeDay;
-float StartTimeNight;
+int StartTimeDay;    // minute of the day
+int StartTimeNight;  // minute of the day
 int StartTimeDayHours;
 int StartTimeDayMinutes;
 int StartTimeNightHours;
@@ -99,9 +210,16 @@ int TimePhase;
 bool OneTimeCodeExecutedDay = false;
 bool OneTimeCodeExecutedNight = false;
 
+// LED strips SK6812, up to 'LEDStripMaxCount' strips shown together by one parallel DMA transfer
+constexpr LEDStripConfig LEDStrips[] = {
+  // pin  pixels  brightness %  tau %  reversed
+  {  27,      41,          100,   100,    false },
+};
+const int LEDStripCount = sizeof(LEDStrips) / sizeof(LEDStrips[0]);
+// color feature of all strips: 'LEDColorGrbw' (SK6812 RGBW) or 'LEDColorGrb' (WS2812 RGB)
+typedef LEDColorGrbw LEDStripColor;
+
 // LED strip calculation program
-const int LEDPixelCount = 41;
-const int LEDPin = 27;
 int LEDStatus;
 int LEDBrightness;
 int LEDAmplifier;
@@ -113,4 +231,47 @@ int LEDColorTopB;
 int LEDColorBottomR;
 int LEDColorBottomG;
 int LEDColorBottomB;
-int LEDColorWhite;
\ No newline at end of file
+int LEDColorWhite;
+
+// LED settings in the order of 'LightSceneValue'
+int* LEDSceneValue[LightSceneValueCount] = {
+  &LEDStatus, &LEDBrightness, &LEDAmplifier, &LEDTauThousand,
+  &LEDColorTopR, &LEDColorTopG, &LEDColorTopB,
+  &LEDColorBottomR, &LEDColorBottomG, &LEDColorBottomB,
+  &LEDColorWhite
+};
+
+// light timeline (keyframes replace the day/night settings when loaded, stored in the settings store)
+const int LEDTimelineUpdateMillis = 1000;
+
+// LED render task (pinned to the application core 1, core 0 runs the WiFi and LwIP tasks; its priority
+// is above the Arduino 'loop()' on the same core, which does network and configuration)
+const int LEDRenderTaskCore = 1;
+const int LEDRenderTaskPriority = 5;
+const int LEDRenderTaskStackSize = 4096;
+const int LEDCommandQueueSize = 8; // power of two
+const uint32_t LEDCommandPostMillis = 40; // bursts (e.g. slider drags) are posted at most once per frame, the newest wins
+const int64_t LEDApplySpinMicros = 1500;  // the render task wakes up this early before an apply time (ticks are slept, the rest below one tick waited actively)
+
+// log task (writes the buffered log lines to the serial interface, on the protocol core at a low priority)
+const int LogTaskCore = 0;
+const int LogTaskPriority = 1;
+const int LogTaskStackSize = 3072;
+
+// event loop ('-D EVENT_LOOP=1'), 'loop()' sleeps until MQTT data, the phase timer or its next deadline
+const bool EventLoopLightSleep = true;        // automatic light sleep while all tasks wait (needs SDK support)
+const uint32_t EventLoopIdleMillis = 1000;    // longest wait online (MQTT keep-alive, NVS commit, diagnostics)
+const uint32_t EventLoopConnectMillis = 100;  // longest wait while connecting
+const int EventLoopWatcherCore = 1;           // MQTT socket watcher, next to 'loop()'
+const int EventLoopWatcherPriority = 2;
+const int EventLoopWatcherStackSize = 2048;
+
+// LED transition (day/night cross-fade)
+const int LEDTransitionFrameMillis = 40; // 25 frames per second
+
+// LED dithering (8.8 frame channels to 8-bit output), frames with fractions are refreshed at this rate
+const int LEDDitherFrameMillis = 10; // 100 frames per second, 0 = rounded to 8 bits without refresh
+const int LEDDitherMaxLevel = 32;    // only channels below this 8-bit level are dithered, brighter ones are rounded
+const int LEDDitherFrameLimit = 500; // refreshes of an unchanged frame (5 s), then it is shown rounded and the
+                                     // output stops until the next frame (0 = no limit)
+int TransitionMinutes;
\ No newline at end of file
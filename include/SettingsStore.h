@@ -0,0 +1,99 @@
+// -------------------------------------------------------------------
+// Settings store - RAM cache of the NVS settings with debounced commits
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Preferences.h>
+#include <LightTimeline.h>
+#include <PhaseSchedule.h>
+
+// persisted integer settings, new settings are only appended (see 'SettingsBlob')
+enum SettingsIndex {
+  SettingStartTimeDayHours,
+  SettingStartTimeDayMinutes,
+  SettingStartTimeNightHours,
+  SettingStartTimeNightMinutes,
+  SettingTransitionMinutes,
+  SettingSceneNight,                                           // 'LightSceneValue' order, nighttime
+  SettingSceneDay = SettingSceneNight + LightSceneValueCount,  // 'LightSceneValue' order, daytime
+  SettingCount = SettingSceneDay + LightSceneValueCount
+};
+
+// index of a LED setting of the time phase
+inline int SettingScene(bool isDayPhase, int Value) {
+  return (isDayPhase ? SettingSceneDay : SettingSceneNight) + Value;
+}
+
+// NVS variable name (legacy, one integer per setting) and standard value of one setting
+struct SettingsField {
+  const char* VariableName;
+  int DefaultValue;
+};
+
+// schema version of 'SettingsBlob', only changed if the layout breaks; appending settings
+// keeps the version, a blob with fewer values gets the standard values for the new ones
+// (version 1: without 'Rules', the values follow the timeline, still readable)
+const uint8_t SettingsBlobVersion = 2;
+
+// all settings persisted as one NVS entry, only 'ValueCount' values are stored
+struct SettingsBlob {
+  uint8_t Version;
+  uint8_t ValueCount;
+  uint16_t Reserved;
+  uint32_t CRC;             // CRC-32 of everything behind this field
+  LightTimeline Timeline;
+  PhaseRules Rules;
+  int32_t Value[SettingCount];
+};
+
+// origin of the settings after 'SettingsStoreLoad'
+enum SettingsSource : uint8_t {
+  SettingsFromBlob,     // one valid blob
+  SettingsFromLegacy,   // imported from the legacy integer variables, blob follows with the next commit
+  SettingsFromDefaults  // nothing stored yet
+};
+
+struct SettingsStore {
+  const char* DBName = nullptr;
+  const char* BlobVariableName = nullptr;
+  const SettingsField* Field = nullptr;   // 'SettingCount' entries
+  const char* TimelineVariableName = nullptr; // legacy timeline entry
+  int32_t Value[SettingCount];
+  LightTimeline Timeline;
+  PhaseRules Rules;                       // weekday and date rules of the time phase
+  uint32_t DirtyMask = 0;                 // one bit per 'SettingsIndex'
+  static_assert(SettingCount < 32, "'DirtyMask' needs one bit per setting, '1UL << SettingCount' must fit");
+  bool isTimelineDirty = false;
+  bool isRulesDirty = false;
+  bool isLegacyImported = false;          // remove the legacy variables with the next commit
+  uint32_t FirstChangeMillis = 0;         // oldest change not committed yet
+  uint32_t LastChangeMillis = 0;          // newest change not committed yet
+  uint32_t WriteCount = 0;                // NVS entries written since boot
+};
+
+// Settings store - CRC-32 (IEEE 802.3), 'Previous' continues the checksum of the preceding data
+uint32_t SettingsCRC32(const void* Data, size_t Length, uint32_t Previous = 0);
+
+// Settings store - read the settings blob with one NVS read, otherwise import the legacy variables once
+SettingsSource SettingsStoreLoad(SettingsStore& Store, Preferences& NVS, const char* DBName, const char* BlobVariableName,
+                                 const SettingsField* Field, const char* TimelineVariableName);
+
+// Settings store - change a setting in RAM, returns false if the value is identical
+bool SettingsStoreSet(SettingsStore& Store, int Index, int32_t Value, uint32_t Now);
+
+// Settings store - replace the light timeline in RAM
+void SettingsStoreSetTimeline(SettingsStore& Store, const LightTimeline& Timeline, uint32_t Now);
+
+// Settings store - replace the phase rules in RAM
+void SettingsStoreSetRules(SettingsStore& Store, const PhaseRules& Rules, uint32_t Now);
+
+// Settings store - write the settings blob if anything changed
+void SettingsStoreCommit(SettingsStore& Store, Preferences& NVS);
+
+// Settings store - commit once no change arrived for 'QuietMillis' (at the latest after 'MaxDelayMillis'),
+// returns true if committed
+bool SettingsStoreService(SettingsStore& Store, Preferences& NVS, uint32_t Now,
+                          uint32_t QuietMillis, uint32_t MaxDelayMillis);
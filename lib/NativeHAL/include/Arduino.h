@@ -0,0 +1,106 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the Arduino core and the FreeRTOS task API
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define IRAM_ATTR
+#define LED_BUILTIN 2
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+
+// text as returned by the Arduino API
+class String {
+public:
+  String(const char* Text = "") : Text(Text) {}
+  String(const std::string& Text) : Text(Text) {}
+  const char* c_str() const { return Text.c_str(); }
+  unsigned int length() const { return Text.size(); }
+  bool operator==(const char* Other) const { return Text == Other; }
+  bool operator!=(const char* Other) const { return Text != Other; }
+private:
+  std::string Text;
+};
+
+// IPv4 address
+class IPAddress {
+public:
+  IPAddress(uint8_t A = 0, uint8_t B = 0, uint8_t C = 0, uint8_t D = 0) : Octet{A, B, C, D} {}
+  String toString() const;
+private:
+  uint8_t Octet[4];
+};
+
+// serial interface, written to 'stdout'
+class HardwareSerial {
+public:
+  void begin(unsigned long Baud) {}
+  int available() { return 0; }
+  int read() { return -1; }
+  size_t write(const uint8_t* Buffer, size_t Size);
+  size_t print(const char* Text);
+  size_t println(const char* Text = "");
+  int printf(const char* Format, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+// chip functions
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getMaxAllocHeap() { return 0; }
+  void restart() { exit(0); }
+};
+extern EspClass ESP;
+// random numbers (hardware generator on the chip, fixed sequence on the host)
+uint32_t esp_random();
+
+// time and pins
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long Millis);
+void delayMicroseconds(uint32_t Micros);
+void pinMode(uint8_t Pin, uint8_t Mode);
+void digitalWrite(uint8_t Pin, uint8_t Value);
+void configTime(long GMTOffsetSeconds, int DaylightOffsetSeconds, const char* Server1,
+                const char* Server2 = nullptr, const char* Server3 = nullptr);
+bool getLocalTime(struct tm* Info, uint32_t Millis = 5000);
+
+// FreeRTOS tasks (one thread per task, ticks are milliseconds)
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffUL
+#define pdMS_TO_TICKS(Millis) ((TickType_t)(Millis))
+#define portTICK_PERIOD_MS 1
+
+BaseType_t xTaskCreatePinnedToCore(void (*Function)(void*), const char* Name, uint32_t StackSize, void* Parameter,
+                                   UBaseType_t Priority, TaskHandle_t* Handle, BaseType_t Core);
+uint32_t ulTaskNotifyTake(BaseType_t ClearOnExit, TickType_t Ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t Handle);
+void vTaskDelay(TickType_t Ticks);
+TickType_t xTaskGetTickCount();
+
+// sketch functions
+void setup();
+void loop();
@@ -0,0 +1,39 @@
+// -------------------------------------------------------------------
+// HAL - control and inspection of the native fakes (host builds only)
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+// HAL - clock: move 'millis()' and the local time forward without waiting
+void HALClockAdvance(uint32_t Millis);
+
+// HAL - timers: move the clock forward to the earliest running 'esp_timer' one-shot and call it,
+// false if none runs (a simulated year takes one step per timer)
+bool HALTimerRunNext();
+
+// HAL - time: report a (re)synchronization of the system time like the SNTP task
+void HALTimeSync();
+
+// HAL - WiFi: allow or refuse connections, drop the current connection
+void HALWiFiSetAvailable(bool isAvailable);
+void HALWiFiDisconnect();
+
+// HAL - MQTT: allow or refuse connections, queue an incoming message for the next 'loop()'
+void HALMQTTSetAvailable(bool isAvailable);
+void HALMQTTInject(const char* TopicName, const char* Payload);
+
+// HAL - MQTT: last payload published on a topic (nullptr if none) and number of publishes
+const char* HALMQTTLastPublished(const char* TopicName);
+bool HALMQTTLastRetained(const char* TopicName);
+uint32_t HALMQTTPublishCount();
+
+// HAL - LED strips: number of parallel transfers (after 'Show()' of every strip) and the last
+// shown pixel of a strip (in the order of construction) as 0xRRGGBBWW
+uint32_t HALStripShowCount();
+uint32_t HALStripPixel(int Strip, int Index);
+
+// HAL - NVS: erase all namespaces, number of write operations
+void HALNVSClear();
+uint32_t HALNVSWriteCount();
@@ -0,0 +1,55 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the NeoPixelBus LED strip
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+struct RgbwColor {
+  RgbwColor(uint8_t R, uint8_t G, uint8_t B, uint8_t W) : R(R), G(G), B(B), W(W) {}
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+  uint8_t W;
+};
+
+struct RgbColor {
+  RgbColor(uint8_t R, uint8_t G, uint8_t B) : R(R), G(G), B(B) {}
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+};
+
+// features and methods only select the hardware, the fake ignores them
+struct NeoGrbFeature {};
+struct NeoGrbwFeature {};
+struct NeoEsp32I2s1X8Ws2812xMethod {};
+struct NeoEsp32I2s1X8Sk6812Method {};
+
+// HAL - LED strips: one channel of the parallel output per strip, 'Show()' hands the pixels
+// (0xRRGGBBWW) of a channel to the inspection functions of 'HAL.h'
+int HALStripRegister(uint8_t Pin);
+void HALStripShow(int Channel, const std::vector<uint32_t>& Pixels);
+
+template <typename Feature, typename Method>
+class NeoPixelBus {
+public:
+  NeoPixelBus(uint16_t PixelCount, uint8_t Pin) : Channel(HALStripRegister(Pin)), Pixels(PixelCount, 0) {}
+  void Begin() {}
+  uint16_t PixelCount() const { return Pixels.size(); }
+  bool CanShow() const { return true; }
+  void SetPixelColor(uint16_t Index, const RgbwColor& Color) {
+    if (Index < Pixels.size()) {
+      Pixels[Index] = (uint32_t)Color.R << 24 | (uint32_t)Color.G << 16 | (uint32_t)Color.B << 8 | Color.W;
+    }
+  }
+  void SetPixelColor(uint16_t Index, const RgbColor& Color) {
+    SetPixelColor(Index, RgbwColor(Color.R, Color.G, Color.B, 0));
+  }
+  void Show(bool MaintainBufferConsistency = true) { HALStripShow(Channel, Pixels); }
+private:
+  int Channel;
+  std::vector<uint32_t> Pixels;
+};
@@ -0,0 +1,23 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the NVS preferences (in memory)
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* Name, bool ReadOnly = false);
+  void end();
+  int32_t getInt(const char* Key, int32_t DefaultValue = 0);
+  size_t putInt(const char* Key, int32_t Value);
+  size_t getBytesLength(const char* Key);
+  size_t getBytes(const char* Key, void* Buffer, size_t MaxLength);
+  size_t putBytes(const char* Key, const void* Value, size_t Length);
+  bool remove(const char* Key);
+  bool clear();
+private:
+  std::string Namespace;
+  bool isOpen = false;
+};
@@ -0,0 +1,37 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the MQTT client (in-process broker)
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+
+// client, publishes are recorded and injected messages are delivered by 'loop()'
+class PubSubClient {
+public:
+  PubSubClient(WiFiClient& Client) {}
+  PubSubClient& setServer(const char* Host, uint16_t Port) { return *this; }
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+  PubSubClient& setSocketTimeout(uint16_t Seconds) { return *this; }
+  PubSubClient& setKeepAlive(uint16_t Seconds) { return *this; }
+  bool setBufferSize(uint16_t Size);
+  uint16_t getBufferSize() { return BufferSize; }
+  bool connect(const char* ClientID);
+  bool connect(const char* ClientID, const char* WillTopic, uint8_t WillQoS, bool WillRetain, const char* WillMessage);
+  void disconnect();
+  bool connected();
+  int state();
+  bool subscribe(const char* TopicName, uint8_t QoS = 0);
+  bool unsubscribe(const char* TopicName);
+  bool publish(const char* TopicName, const char* Payload);
+  bool publish(const char* TopicName, const char* Payload, bool Retained);
+  bool publish(const char* TopicName, const uint8_t* Payload, unsigned int Length, bool Retained);
+  bool loop();
+private:
+  void (*Callback)(char*, uint8_t*, unsigned int) = nullptr;
+  uint16_t BufferSize = 256;
+  bool isConnected = false;
+};
@@ -0,0 +1,7 @@
+// -------------------------------------------------------------------
+// WiFi Settings (host builds, the project 'include/SettingsWiFi.h' takes precedence)
+// -------------------------------------------------------------------
+
+const char* WiFiSSID = "NativeSSID";
+const char* WiFiPassword = "NativePassword";
+const char* WiFiHostname = "ShrimptasticEcoHub";
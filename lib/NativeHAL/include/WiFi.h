@@ -0,0 +1,35 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the WiFi station
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+enum WiFiEvent_t {
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP
+};
+typedef int WiFiEventInfo_t;
+typedef void (*WiFiEventCb)(WiFiEvent_t Event, WiFiEventInfo_t Info);
+
+// station, a connection attempt succeeds immediately while 'HALWiFiSetAvailable(true)'
+class WiFiClass {
+public:
+  int onEvent(WiFiEventCb Callback, WiFiEvent_t Event);
+  bool hostname(const char* Name) { return true; }
+  int begin(const char* SSID, const char* Password);
+  bool disconnect(bool WiFiOff = false);
+  IPAddress localIP();
+  uint8_t* macAddress(uint8_t* MAC);
+};
+extern WiFiClass WiFi;
+
+// network client, the MQTT fake does not use a socket; 'fd()' is a pipe that becomes readable
+// while injected messages wait for 'PubSubClient::loop()' (like the socket of a real session)
+class WiFiClient {
+public:
+  int fd() const;
+  int available() { return 0; }
+};
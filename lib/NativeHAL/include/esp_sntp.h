@@ -0,0 +1,12 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the ESP-IDF SNTP notification
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+// the callback is called by 'configTime()' and 'HALTimeSync()'
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
@@ -0,0 +1,32 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the ESP-IDF high resolution timer
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+typedef struct HALTimer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum {
+  ESP_TIMER_TASK
+} esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+// microseconds since start, monotonic (moved forward by 'HALClockAdvance()')
+int64_t esp_timer_get_time();
+
+// one-shot timers, expired by 'HALClockAdvance()' and 'HALTimerRunNext()' (callback in the caller's thread)
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
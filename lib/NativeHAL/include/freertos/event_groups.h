@@ -0,0 +1,16 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the FreeRTOS event groups
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+typedef struct HALEventGroup* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t Group, EventBits_t Bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t Group, EventBits_t Bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t Group, EventBits_t Bits, BaseType_t ClearOnExit,
+                                BaseType_t WaitForAll, TickType_t Ticks);
@@ -0,0 +1,18 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the NVS partition
+// -------------------------------------------------------------------
+
+#pragma once
+
+#include <HAL.h>
+
+typedef int esp_err_t;
+
+inline esp_err_t nvs_flash_erase() {
+  HALNVSClear();
+  return 0;
+}
+
+inline esp_err_t nvs_flash_init() {
+  return 0;
+}
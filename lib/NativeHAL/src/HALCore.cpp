@@ -0,0 +1,356 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the Arduino core and the FreeRTOS task API
+// -------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <HAL.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <esp_pm.h>
+#include <freertos/event_groups.h>
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// clock - time since start plus the offset of 'HALClockAdvance()'
+static const std::chrono::steady_clock::time_point HALClockStart = std::chrono::steady_clock::now();
+static std::atomic<uint64_t> HALClockOffsetMillis{0};
+
+static void HALTimerExpire();
+
+// HAL - clock: move 'millis()' and the local time forward without waiting, expired timers are called
+void HALClockAdvance(uint32_t Millis) {
+  HALClockOffsetMillis += Millis;
+  HALTimerExpire();
+}
+
+// HAL - clock: microseconds since start
+static uint64_t HALClockMicros() {
+  auto Elapsed = std::chrono::steady_clock::now() - HALClockStart;
+  return std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count() +
+         (uint64_t)HALClockOffsetMillis.load() * 1000;
+}
+
+unsigned long millis() {
+  return (unsigned long)(HALClockMicros() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)HALClockMicros();
+}
+
+uint32_t esp_random() {
+  // fixed sequence, host runs are reproducible
+  static std::atomic<uint32_t> State{0x2545F491};
+  uint32_t Value = State.load();
+  uint32_t Next;
+  do {
+    Next = Value ^ (Value << 13);
+    Next ^= Next >> 17;
+    Next ^= Next << 5;
+  } while (!State.compare_exchange_weak(Value, Next));
+  return Next;
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)HALClockMicros();
+}
+
+// timers - one-shot timers of 'esp_timer_create()', a deadline of 0 is stopped
+struct HALTimer {
+  esp_timer_cb_t Callback;
+  void* Argument;
+  uint64_t DeadlineMicros;
+  bool isUsed;
+};
+static HALTimer HALTimers[8];
+static std::mutex HALTimerMutex;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+  std::lock_guard<std::mutex> Lock(HALTimerMutex);
+  for (HALTimer& Timer : HALTimers) {
+    if (!Timer.isUsed) {
+      Timer = {create_args->callback, create_args->arg, 0, true};
+      *out_handle = &Timer;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  std::lock_guard<std::mutex> Lock(HALTimerMutex);
+  if (timer->DeadlineMicros != 0) {
+    return -1;
+  }
+  timer->DeadlineMicros = HALClockMicros() + (timeout_us > 0 ? timeout_us : 1);
+  return 0;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> Lock(HALTimerMutex);
+  bool isRunning = timer->DeadlineMicros != 0;
+  timer->DeadlineMicros = 0;
+  return isRunning ? 0 : -1;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> Lock(HALTimerMutex);
+  timer->DeadlineMicros = 0;
+  timer->isUsed = false;
+  return 0;
+}
+
+// HAL - timers: call the callbacks of all expired timers (outside of the lock, they may start timers)
+static void HALTimerExpire() {
+  for (;;) {
+    HALTimer* Expired = nullptr;
+    {
+      std::lock_guard<std::mutex> Lock(HALTimerMutex);
+      uint64_t Now = HALClockMicros();
+      for (HALTimer& Timer : HALTimers) {
+        if (Timer.isUsed && Timer.DeadlineMicros != 0 && Timer.DeadlineMicros <= Now) {
+          Expired = &Timer;
+          Timer.DeadlineMicros = 0;
+          break;
+        }
+      }
+    }
+    if (Expired == nullptr) {
+      return;
+    }
+    Expired->Callback(Expired->Argument);
+  }
+}
+
+// HAL - timers: move the clock forward to the earliest running timer and call it, false if none runs
+bool HALTimerRunNext() {
+  uint64_t Deadline = 0;
+  {
+    std::lock_guard<std::mutex> Lock(HALTimerMutex);
+    for (HALTimer& Timer : HALTimers) {
+      if (Timer.isUsed && Timer.DeadlineMicros != 0 && (Deadline == 0 || Timer.DeadlineMicros < Deadline)) {
+        Deadline = Timer.DeadlineMicros;
+      }
+    }
+  }
+  if (Deadline == 0) {
+    return false;
+  }
+  uint64_t Now = HALClockMicros();
+  HALClockAdvance(Deadline > Now ? (uint32_t)((Deadline - Now + 999) / 1000) : 0);
+  return true;
+}
+
+void delay(unsigned long Millis) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(Millis));
+}
+
+void delayMicroseconds(uint32_t Micros) {
+  std::this_thread::sleep_for(std::chrono::microseconds(Micros));
+}
+
+void pinMode(uint8_t Pin, uint8_t Mode) {}
+
+void digitalWrite(uint8_t Pin, uint8_t Value) {}
+
+// time - callback of 'sntp_set_time_sync_notification_cb()'
+static sntp_sync_time_cb_t HALTimeSyncCallback = nullptr;
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+  HALTimeSyncCallback = callback;
+}
+
+// HAL - time: report a (re)synchronization of the system time like the SNTP task
+void HALTimeSync() {
+  if (HALTimeSyncCallback != nullptr) {
+    struct timeval Time;
+    gettimeofday(&Time, nullptr);
+    HALTimeSyncCallback(&Time);
+  }
+}
+
+// time - the host clock is already synchronized, 'configTime()' only reports it
+void configTime(long GMTOffsetSeconds, int DaylightOffsetSeconds, const char* Server1,
+                const char* Server2, const char* Server3) {
+  HALTimeSync();
+}
+
+bool getLocalTime(struct tm* Info, uint32_t Millis) {
+  time_t Now = time(nullptr) + HALClockOffsetMillis.load() / 1000;
+  return localtime_r(&Now, Info) != nullptr;
+}
+
+uint32_t EspClass::getCycleCount() {
+  auto Elapsed = std::chrono::steady_clock::now() - HALClockStart;
+  return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(Elapsed).count() * getCpuFreqMHz() / 1000);
+}
+
+String IPAddress::toString() const {
+  char Text[16];
+  snprintf(Text, sizeof(Text), "%u.%u.%u.%u", Octet[0], Octet[1], Octet[2], Octet[3]);
+  return String(Text);
+}
+
+size_t HardwareSerial::write(const uint8_t* Buffer, size_t Size) {
+  return fwrite(Buffer, 1, Size, stdout);
+}
+
+size_t HardwareSerial::print(const char* Text) {
+  return fputs(Text, stdout) < 0 ? 0 : strlen(Text);
+}
+
+size_t HardwareSerial::println(const char* Text) {
+  return print(Text) + print("\n");
+}
+
+int HardwareSerial::printf(const char* Format, ...) {
+  va_list Arguments;
+  va_start(Arguments, Format);
+  int Length = vprintf(Format, Arguments);
+  va_end(Arguments);
+  return Length;
+}
+
+// one FreeRTOS task: a detached thread with its notification value
+struct HALTask {
+  std::mutex Mutex;
+  std::condition_variable Signal;
+  uint32_t Notification = 0;
+};
+
+// task of the calling thread, the sketch ('setup()' and 'loop()') runs as its own task
+static thread_local HALTask* HALCurrentTask = nullptr;
+
+static HALTask& HALTaskSelf() {
+  if (HALCurrentTask == nullptr) {
+    HALCurrentTask = new HALTask;
+  }
+  return *HALCurrentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*Function)(void*), const char* Name, uint32_t StackSize, void* Parameter,
+                                   UBaseType_t Priority, TaskHandle_t* Handle, BaseType_t Core) {
+  HALTask* Task = new HALTask;
+  if (Handle != nullptr) {
+    *Handle = Task;
+  }
+  std::thread([Function, Parameter, Task]() {
+    HALCurrentTask = Task;
+    Function(Parameter);
+  }).detach();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t ClearOnExit, TickType_t Ticks) {
+  HALTask& Task = HALTaskSelf();
+  std::unique_lock<std::mutex> Lock(Task.Mutex);
+  auto isNotified = [&Task]() { return Task.Notification > 0; };
+  if (Ticks == portMAX_DELAY) {
+    Task.Signal.wait(Lock, isNotified);
+  }
+  else {
+    Task.Signal.wait_for(Lock, std::chrono::milliseconds(Ticks), isNotified);
+  }
+  uint32_t Value = Task.Notification;
+  if (Value > 0) {
+    Task.Notification = ClearOnExit ? 0 : Value - 1;
+  }
+  return Value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t Handle) {
+  HALTask* Task = static_cast<HALTask*>(Handle);
+  {
+    std::lock_guard<std::mutex> Lock(Task->Mutex);
+    Task->Notification++;
+  }
+  Task->Signal.notify_one();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t Ticks) {
+  delay(Ticks);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+// one FreeRTOS event group: bits with a condition for the waiting tasks
+struct HALEventGroup {
+  std::mutex Mutex;
+  std::condition_variable Signal;
+  EventBits_t Bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() {
+  return new HALEventGroup;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t Group, EventBits_t Bits) {
+  EventBits_t Value;
+  {
+    std::lock_guard<std::mutex> Lock(Group->Mutex);
+    Group->Bits |= Bits;
+    Value = Group->Bits;
+  }
+  Group->Signal.notify_all();
+  return Value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t Group, EventBits_t Bits) {
+  std::lock_guard<std::mutex> Lock(Group->Mutex);
+  EventBits_t Value = Group->Bits;
+  Group->Bits &= ~Bits;
+  return Value;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t Group, EventBits_t Bits, BaseType_t ClearOnExit,
+                                BaseType_t WaitForAll, TickType_t Ticks) {
+  std::unique_lock<std::mutex> Lock(Group->Mutex);
+  auto isSet = [Group, Bits, WaitForAll]() {
+    return WaitForAll ? (Group->Bits & Bits) == Bits : (Group->Bits & Bits) != 0;
+  };
+  if (Ticks == portMAX_DELAY) {
+    Group->Signal.wait(Lock, isSet);
+  }
+  else {
+    Group->Signal.wait_for(Lock, std::chrono::milliseconds(Ticks), isSet);
+  }
+  EventBits_t Value = Group->Bits;
+  if (ClearOnExit && isSet()) {
+    Group->Bits &= ~Bits;
+  }
+  return Value;
+}
+
+// power management - accepted, but the host neither changes frequencies nor sleeps
+struct HALPMLock {
+  uint32_t Count = 0;
+};
+
+esp_err_t esp_pm_configure(const void* config) {
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char* name, esp_pm_lock_handle_t* out_handle) {
+  *out_handle = new HALPMLock;
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+  handle->Count++;
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+  handle->Count--;
+  return ESP_OK;
+}
@@ -0,0 +1,211 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the MQTT client (in-process broker)
+// -------------------------------------------------------------------
+
+#include <PubSubClient.h>
+#include <HAL.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// broker state, shared with the host program
+struct HALMQTTMessage {
+  std::string Payload;
+  bool isRetained;
+};
+static std::mutex HALMQTTMutex;
+static bool HALMQTTAvailable = true;
+static std::set<std::string> HALMQTTSubscribed;
+static std::map<std::string, HALMQTTMessage> HALMQTTPublished;
+static std::deque<std::pair<std::string, std::string>> HALMQTTIncoming;
+static uint32_t HALMQTTPublishTotal = 0;
+// pipe with one byte per waiting message, read end as socket of the client
+static int HALMQTTPipe[2] = {-1, -1};
+
+// HAL - MQTT: create the pipe once (non-blocking, so 'loop()' can drain it)
+static void HALMQTTPipeOpen() {
+  if (HALMQTTPipe[0] < 0 && pipe(HALMQTTPipe) == 0) {
+    fcntl(HALMQTTPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(HALMQTTPipe[1], F_SETFL, O_NONBLOCK);
+  }
+}
+
+// HAL - MQTT: topic filter with '+' (one level) and '#' (all remaining levels) matches 'TopicName'
+static bool HALMQTTMatch(const std::string& Filter, const std::string& TopicName) {
+  size_t f = 0;
+  size_t t = 0;
+  while (f < Filter.size()) {
+    if (Filter[f] == '#') {
+      return true;
+    }
+    if (Filter[f] == '+') {
+      while (t < TopicName.size() && TopicName[t] != '/') {
+        t++;
+      }
+      f++;
+      continue;
+    }
+    if (t >= TopicName.size() || Filter[f] != TopicName[t]) {
+      return false;
+    }
+    f++;
+    t++;
+  }
+  return t == TopicName.size();
+}
+
+// HAL - MQTT: any subscription matches 'TopicName'
+static bool HALMQTTIsSubscribed(const std::string& TopicName) {
+  for (const std::string& Filter : HALMQTTSubscribed) {
+    if (HALMQTTMatch(Filter, TopicName)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int WiFiClient::fd() const {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  HALMQTTPipeOpen();
+  return HALMQTTPipe[0];
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+  Callback = callback;
+  return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t Size) {
+  BufferSize = Size;
+  return true;
+}
+
+bool PubSubClient::connect(const char* ClientID) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  isConnected = HALMQTTAvailable;
+  return isConnected;
+}
+
+bool PubSubClient::connect(const char* ClientID, const char* WillTopic, uint8_t WillQoS, bool WillRetain,
+                           const char* WillMessage) {
+  return connect(ClientID);
+}
+
+void PubSubClient::disconnect() {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  isConnected = false;
+  HALMQTTSubscribed.clear();
+}
+
+bool PubSubClient::connected() {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  if (!HALMQTTAvailable) {
+    isConnected = false;
+  }
+  return isConnected;
+}
+
+int PubSubClient::state() {
+  return isConnected ? 0 : -2;
+}
+
+bool PubSubClient::subscribe(const char* TopicName, uint8_t QoS) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  HALMQTTSubscribed.insert(TopicName);
+  return isConnected;
+}
+
+bool PubSubClient::unsubscribe(const char* TopicName) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  HALMQTTSubscribed.erase(TopicName);
+  return isConnected;
+}
+
+bool PubSubClient::publish(const char* TopicName, const char* Payload) {
+  return publish(TopicName, reinterpret_cast<const uint8_t*>(Payload), strlen(Payload), false);
+}
+
+bool PubSubClient::publish(const char* TopicName, const char* Payload, bool Retained) {
+  return publish(TopicName, reinterpret_cast<const uint8_t*>(Payload), strlen(Payload), Retained);
+}
+
+bool PubSubClient::publish(const char* TopicName, const uint8_t* Payload, unsigned int Length, bool Retained) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  // like the library, a message that does not fit into the buffer is not sent
+  if (!isConnected || strlen(TopicName) + Length + 7 > BufferSize) {
+    return false;
+  }
+  HALMQTTPublished[TopicName] = HALMQTTMessage{std::string(reinterpret_cast<const char*>(Payload), Length), Retained};
+  HALMQTTPublishTotal++;
+  return true;
+}
+
+// deliver queued messages of subscribed topics, the payload is not terminated (like the library buffer)
+bool PubSubClient::loop() {
+  {
+    // all waiting messages are delivered below, the socket is no longer readable
+    std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+    char Drain[64];
+    while (HALMQTTPipe[0] >= 0 && isConnected && read(HALMQTTPipe[0], Drain, sizeof(Drain)) > 0) {
+    }
+  }
+  for (;;) {
+    std::pair<std::string, std::string> Message;
+    {
+      std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+      if (!isConnected || HALMQTTIncoming.empty()) {
+        return isConnected;
+      }
+      Message = HALMQTTIncoming.front();
+      HALMQTTIncoming.pop_front();
+      if (!HALMQTTIsSubscribed(Message.first) || Message.first.size() + Message.second.size() + 7 > BufferSize) {
+        continue;
+      }
+    }
+    if (Callback != nullptr) {
+      std::vector<char> TopicName(Message.first.begin(), Message.first.end());
+      TopicName.push_back('\0');
+      std::vector<uint8_t> Payload(Message.second.begin(), Message.second.end());
+      Payload.push_back(0xA5); // no terminator
+      Callback(TopicName.data(), Payload.data(), Message.second.size());
+    }
+  }
+}
+
+// HAL - MQTT: allow or refuse connections, queue an incoming message for the next 'loop()'
+void HALMQTTSetAvailable(bool isAvailable) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  HALMQTTAvailable = isAvailable;
+}
+
+void HALMQTTInject(const char* TopicName, const char* Payload) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  HALMQTTIncoming.emplace_back(TopicName, Payload);
+  HALMQTTPipeOpen();
+  if (HALMQTTPipe[1] >= 0 && write(HALMQTTPipe[1], "M", 1) < 0) {
+    // pipe full, the waiting bytes already signal the socket
+  }
+}
+
+// HAL - MQTT: last payload published on a topic (nullptr if none) and number of publishes
+const char* HALMQTTLastPublished(const char* TopicName) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  auto Message = HALMQTTPublished.find(TopicName);
+  return Message == HALMQTTPublished.end() ? nullptr : Message->second.Payload.c_str();
+}
+
+bool HALMQTTLastRetained(const char* TopicName) {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  auto Message = HALMQTTPublished.find(TopicName);
+  return Message != HALMQTTPublished.end() && Message->second.isRetained;
+}
+
+uint32_t HALMQTTPublishCount() {
+  std::lock_guard<std::mutex> Lock(HALMQTTMutex);
+  return HALMQTTPublishTotal;
+}
@@ -0,0 +1,24 @@
+// -------------------------------------------------------------------
+// HAL - entry point of host builds, runs the sketch like the Arduino core
+// -------------------------------------------------------------------
+
+#include <Arduino.h>
+
+// host programs with their own 'main()' (e.g. benchmarks) define 'HAL_NO_MAIN', unit tests bring theirs
+#if !defined(HAL_NO_MAIN) && !defined(PIO_UNIT_TESTING)
+
+// run 'setup()' once and 'loop()' for the given number of milliseconds (argument, default: 10 s)
+int main(int argc, char** argv) {
+  unsigned long RunMillis = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+  setup();
+  unsigned long Start = millis();
+  while (millis() - Start < RunMillis) {
+    loop();
+    // like the idle time of the Arduino loop task, gives the other threads a chance
+    delay(1);
+  }
+  fflush(stdout);
+  return 0;
+}
+
+#endif
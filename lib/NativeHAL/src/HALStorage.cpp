@@ -0,0 +1,134 @@
+// -------------------------------------------------------------------
+// HAL - native fakes of the NVS preferences and the LED strip output
+// -------------------------------------------------------------------
+
+#include <Preferences.h>
+#include <NeoPixelBus.h>
+#include <HAL.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// NVS - namespace and key to the stored bytes ('putInt()' stores 4 bytes)
+static std::mutex HALNVSMutex;
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> HALNVS;
+static uint32_t HALNVSWrites = 0;
+
+bool Preferences::begin(const char* Name, bool ReadOnly) {
+  Namespace = Name;
+  isOpen = true;
+  return true;
+}
+
+void Preferences::end() {
+  isOpen = false;
+}
+
+int32_t Preferences::getInt(const char* Key, int32_t DefaultValue) {
+  int32_t Value = DefaultValue;
+  getBytes(Key, &Value, sizeof(Value));
+  return Value;
+}
+
+size_t Preferences::putInt(const char* Key, int32_t Value) {
+  return putBytes(Key, &Value, sizeof(Value));
+}
+
+size_t Preferences::getBytesLength(const char* Key) {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  auto& Entries = HALNVS[Namespace];
+  auto Entry = Entries.find(Key);
+  return !isOpen || Entry == Entries.end() ? 0 : Entry->second.size();
+}
+
+size_t Preferences::getBytes(const char* Key, void* Buffer, size_t MaxLength) {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  auto& Entries = HALNVS[Namespace];
+  auto Entry = Entries.find(Key);
+  // like the library, a value larger than the buffer is not read at all
+  if (!isOpen || Entry == Entries.end() || Entry->second.size() > MaxLength) {
+    return 0;
+  }
+  memcpy(Buffer, Entry->second.data(), Entry->second.size());
+  return Entry->second.size();
+}
+
+size_t Preferences::putBytes(const char* Key, const void* Value, size_t Length) {
+  if (!isOpen) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  const uint8_t* Bytes = static_cast<const uint8_t*>(Value);
+  HALNVS[Namespace][Key].assign(Bytes, Bytes + Length);
+  HALNVSWrites++;
+  return Length;
+}
+
+bool Preferences::remove(const char* Key) {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  return isOpen && HALNVS[Namespace].erase(Key) > 0;
+}
+
+bool Preferences::clear() {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  HALNVS[Namespace].clear();
+  return isOpen;
+}
+
+// HAL - NVS: erase all namespaces, number of write operations
+void HALNVSClear() {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  HALNVS.clear();
+}
+
+uint32_t HALNVSWriteCount() {
+  std::lock_guard<std::mutex> Lock(HALNVSMutex);
+  return HALNVSWrites;
+}
+
+// LED strips - channels of the parallel output, pixels of the last transfer
+struct HALStripChannel {
+  std::vector<uint32_t> Pixels;
+  bool isUpdated;
+};
+static std::mutex HALStripMutex;
+static std::vector<HALStripChannel> HALStripChannels;
+static uint32_t HALStripShows = 0;
+
+int HALStripRegister(uint8_t Pin) {
+  std::lock_guard<std::mutex> Lock(HALStripMutex);
+  HALStripChannels.push_back(HALStripChannel{std::vector<uint32_t>(), false});
+  return (int)HALStripChannels.size() - 1;
+}
+
+// like the X8 method: one transfer of all channels as soon as every channel called 'Show()'
+void HALStripShow(int Channel, const std::vector<uint32_t>& Pixels) {
+  std::lock_guard<std::mutex> Lock(HALStripMutex);
+  HALStripChannels[Channel].Pixels = Pixels;
+  HALStripChannels[Channel].isUpdated = true;
+  for (const HALStripChannel& Other : HALStripChannels) {
+    if (!Other.isUpdated) {
+      return;
+    }
+  }
+  for (HALStripChannel& Other : HALStripChannels) {
+    Other.isUpdated = false;
+  }
+  HALStripShows++;
+}
+
+// HAL - LED strips: number of parallel transfers and the last shown pixel of a strip as 0xRRGGBBWW
+uint32_t HALStripShowCount() {
+  std::lock_guard<std::mutex> Lock(HALStripMutex);
+  return HALStripShows;
+}
+
+uint32_t HALStripPixel(int Strip, int Index) {
+  std::lock_guard<std::mutex> Lock(HALStripMutex);
+  if (Strip < 0 || Strip >= (int)HALStripChannels.size()) {
+    return 0;
+  }
+  const std::vector<uint32_t>& Pixels = HALStripChannels[Strip].Pixels;
+  return Index >= 0 && Index < (int)Pixels.size() ? Pixels[Index] : 0;
+}
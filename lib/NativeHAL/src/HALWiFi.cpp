@@ -0,0 +1,74 @@
+// -------------------------------------------------------------------
+// HAL - native fake of the WiFi station
+// -------------------------------------------------------------------
+
+#include <WiFi.h>
+#include <HAL.h>
+#include <string.h>
+#include <atomic>
+
+WiFiClass WiFi;
+
+static const int HALWiFiEventCount = 3;
+static WiFiEventCb HALWiFiCallback[HALWiFiEventCount][4];
+static std::atomic<bool> HALWiFiAvailable{true};
+static std::atomic<bool> HALWiFiConnected{false};
+
+// HAL - WiFi: call the event handlers, like the WiFi event task of the ESP32 does
+static void HALWiFiEvent(WiFiEvent_t Event) {
+  for (int i = 0; i < 4; ++i) {
+    if (HALWiFiCallback[Event][i] != nullptr) {
+      HALWiFiCallback[Event][i](Event, 0);
+    }
+  }
+}
+
+int WiFiClass::onEvent(WiFiEventCb Callback, WiFiEvent_t Event) {
+  for (int i = 0; i < 4; ++i) {
+    if (HALWiFiCallback[Event][i] == nullptr) {
+      HALWiFiCallback[Event][i] = Callback;
+      return Event * 4 + i;
+    }
+  }
+  return -1;
+}
+
+int WiFiClass::begin(const char* SSID, const char* Password) {
+  if (!HALWiFiAvailable) {
+    return 0;
+  }
+  HALWiFiConnected = true;
+  HALWiFiEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+  HALWiFiEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  return 1;
+}
+
+bool WiFiClass::disconnect(bool WiFiOff) {
+  HALWiFiDisconnect();
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return HALWiFiConnected ? IPAddress(192, 168, 178, 99) : IPAddress();
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* MAC) {
+  // fixed station address (Espressif OUI)
+  static const uint8_t Address[6] = {0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56};
+  memcpy(MAC, Address, sizeof(Address));
+  return MAC;
+}
+
+// HAL - WiFi: allow or refuse connections, drop the current connection
+void HALWiFiSetAvailable(bool isAvailable) {
+  HALWiFiAvailable = isAvailable;
+  if (!isAvailable) {
+    HALWiFiDisconnect();
+  }
+}
+
+void HALWiFiDisconnect() {
+  if (HALWiFiConnected.exchange(false)) {
+    HALWiFiEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+}
@@ -0,0 +1,263 @@
+// -------------------------------------------------------------------
+// Benchmark - timing of the render and configuration paths ('-D BENCHMARK')
+// -------------------------------------------------------------------
+
+#ifdef BENCHMARK
+
+#include <Arduino.h>
+#include <Benchmark.h>
+#include <BenchmarkThresholds.h>
+#include <LEDGradient.h>
+#include <LEDRenderer.h>
+#include <LightTimeline.h>
+#include <PhaseSchedule.h>
+#include <SettingsStore.h>
+#include <Log.h>
+#include <algorithm>
+#include <atomic>
+#ifndef ESP_PLATFORM
+#include <time.h>
+#endif
+
+// firmware functions and objects under test (main.cpp)
+void LEDColorControl(const LightScene& Scene);
+void LEDColorControl();
+void MQTTCallback(char* TopicPath, byte* Message, unsigned int MessageLength);
+void NVSReadSettings(bool ReadTimeSettings, bool ReadTimePhaseSettings);
+void LEDStripShowFrames(const LEDFrame* Frames, bool isDithered);
+extern SettingsStore Settings;
+extern LEDFrame LEDFrameBuffer[];
+extern char MQTTCommandPrefix[];
+
+// sweeps of the render path (pixel counts 8, 41, 72 and 'LEDCurveMaxPixels', see 'BenchmarkRenderer()')
+static const int BenchmarkAmplifiers[] = {-100, -50, 0, 50, 100};
+static const int BenchmarkTauThousands[] = {1000, 5125, 8200};
+
+// daytime standard values as base scene
+static const LightScene BenchmarkScene = {{1, 70, 0, 5125, 0, 193, 255, 194, 255, 0, 70}};
+
+static uint32_t BenchmarkSample[BenchmarkIterations];
+static std::atomic<bool> BenchmarkRenderPathDone{false};
+static std::atomic<int> BenchmarkFailed{0};
+static int BenchmarkCases = 0;
+
+// Benchmark - time stamp, CPU cycles on the ESP32, CPU time of the calling thread in nanoseconds on
+// the host (the host tasks share its CPUs, their time slices are not counted)
+static inline uint32_t BenchmarkNow() {
+#ifdef ESP_PLATFORM
+  return ESP.getCycleCount();
+#else
+  struct timespec Time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time);
+  return (uint32_t)((uint64_t)Time.tv_sec * 1000000000u + Time.tv_nsec);
+#endif
+}
+
+// Benchmark - nanoseconds between two time stamps
+static inline uint32_t BenchmarkNanos(uint32_t Start, uint32_t End) {
+#ifdef ESP_PLATFORM
+  return (uint32_t)((uint64_t)(End - Start) * 1000 / ESP.getCpuFreqMHz());
+#else
+  return End - Start;
+#endif
+}
+
+// Benchmark - limits of a case in nanoseconds, 0 = no limit
+static void BenchmarkLimitOf(const char* Case, int Pixels, uint32_t& MedianLimit, uint32_t& P99Limit) {
+  MedianLimit = 0;
+  P99Limit = 0;
+  for (int i = 0; i < BenchmarkLimitCount; ++i) {
+    if (strcmp(BenchmarkLimits[i].Case, Case) == 0) {
+      MedianLimit = BenchmarkLimits[i].MedianBase + BenchmarkLimits[i].MedianPerPixel * Pixels;
+      P99Limit = BenchmarkLimits[i].P99Base + BenchmarkLimits[i].P99PerPixel * Pixels;
+    }
+  }
+}
+
+// Benchmark - sort the samples and compare them with the limits, cases without limit always pass
+static bool BenchmarkEvaluate(const char* Case, int Pixels) {
+  std::sort(BenchmarkSample, BenchmarkSample + BenchmarkIterations);
+  uint32_t Median = BenchmarkSample[BenchmarkIterations / 2];
+  uint32_t P99 = BenchmarkSample[BenchmarkIterations * 99 / 100];
+  uint32_t MedianLimit;
+  uint32_t P99Limit;
+  BenchmarkLimitOf(Case, Pixels, MedianLimit, P99Limit);
+  return (MedianLimit == 0 || Median <= MedianLimit) && (P99Limit == 0 || P99 <= P99Limit);
+}
+
+// Benchmark - print one JSON line with the sorted samples of a case
+static void BenchmarkReport(const char* Case, int Pixels, int Amplifier, int TauThousand, int Attempts, bool isPassed) {
+  uint32_t MedianLimit;
+  uint32_t P99Limit;
+  BenchmarkLimitOf(Case, Pixels, MedianLimit, P99Limit);
+  if (!isPassed) {
+    BenchmarkFailed++;
+  }
+  BenchmarkCases++;
+  Serial.printf("BENCH {\"case\":\"%s\",\"pixels\":%d,\"amplifier\":%d,\"tau\":%d,\"log_level\":%d,"
+                "\"n\":%d,\"attempts\":%d,\"min_ns\":%u,\"median_ns\":%u,\"p99_ns\":%u,"
+                "\"median_limit_ns\":%u,\"p99_limit_ns\":%u,\"pass\":%s}\n",
+                Case, Pixels, Amplifier, TauThousand, LOG_LEVEL, BenchmarkIterations, Attempts,
+                (unsigned)BenchmarkSample[0], (unsigned)BenchmarkSample[BenchmarkIterations / 2],
+                (unsigned)BenchmarkSample[BenchmarkIterations * 99 / 100], (unsigned)MedianLimit, (unsigned)P99Limit,
+                isPassed ? "true" : "false");
+}
+
+// Benchmark - time 'Body(Iteration)' 'BenchmarkIterations' times after the warm-up, a case above its
+// limits is measured again (up to 'BenchmarkAttempts' times), a stall of the machine does not repeat
+// but a regression does
+template <typename Function>
+static void BenchmarkRun(const char* Case, int Pixels, int Amplifier, int TauThousand, Function Body) {
+  int Attempts = 0;
+  bool isPassed = false;
+  while (!isPassed && Attempts < BenchmarkAttempts) {
+    for (int i = 0; i < BenchmarkWarmupIterations; ++i) {
+      Body(i);
+    }
+    delay(BenchmarkSettleMillis);
+    for (int i = 0; i < BenchmarkIterations; ++i) {
+      uint32_t Start = BenchmarkNow();
+      Body(i);
+      BenchmarkSample[i] = BenchmarkNanos(Start, BenchmarkNow());
+    }
+    isPassed = BenchmarkEvaluate(Case, Pixels);
+    Attempts++;
+  }
+  BenchmarkReport(Case, Pixels, Amplifier, TauThousand, Attempts, isPassed);
+}
+
+// Benchmark - curve table and render (gradient and white balance) of the renderer specialized for
+// 'Pixels' (RGBW), as used by 'LEDColorControl()'
+template <int Pixels>
+static void BenchmarkRenderer(LEDCurveTable& Curve, LEDFrame& Frame) {
+  // curve table, rebuilt in every iteration
+  for (int Amplifier : BenchmarkAmplifiers) {
+    for (int TauThousand : BenchmarkTauThousands) {
+      BenchmarkRun("LEDRenderer/CurveUpdate", Pixels, Amplifier, TauThousand, [&](int i) {
+        Curve.isValid = false;
+        LEDRenderer<Pixels, LEDColorGrbw>::CurveUpdate(Curve, Amplifier, TauThousand);
+      });
+    }
+  }
+  // gradient and white balance, the curve table is prepared by the first iteration
+  BenchmarkRun("LEDRenderer/Render", Pixels, 50, 5125, [&](int i) {
+    LEDGradientColors Gradient = {194 << 8, 255 << 8, 0, 0, 193 << 8, (255 - (i & 1)) << 8, 70 << 8, 50, 5125};
+    LEDRenderer<Pixels, LEDColorGrbw>::Render(Frame, Curve, Gradient);
+  });
+}
+
+// Benchmark - render path (curve table, gradient, 'LEDColorControl()', dithered refresh), called by the render task
+void BenchmarkRenderPath(int DitherFrameMillis, int PixelCount) {
+  static LEDCurveTable Curve;
+  static LEDFrame Frame;
+  Serial.printf("BENCH {\"start\":\"render\",\"log_level\":%d}\n", LOG_LEVEL);
+  BenchmarkRenderer<8>(Curve, Frame);
+  BenchmarkRenderer<41>(Curve, Frame);
+  BenchmarkRenderer<72>(Curve, Frame);
+  BenchmarkRenderer<LEDCurveMaxPixels>(Curve, Frame);
+  // complete render and output of the strip, the curve table changes with the first iteration only
+  for (int Amplifier : BenchmarkAmplifiers) {
+    for (int TauThousand : BenchmarkTauThousands) {
+      LightScene Scene = BenchmarkScene;
+      Scene.Value[LightAmplifier] = Amplifier;
+      Scene.Value[LightTauThousand] = TauThousand;
+      // alternating brightness, so that every iteration changes the frame and shows it
+      BenchmarkRun("LEDColorControl", PixelCount, Amplifier, TauThousand, [&](int i) {
+        Scene.Value[LightBrightness] = 70 - (i & 1);
+        LEDColorControl(Scene);
+      });
+    }
+  }
+  // dithered refresh of the frames shown last (night scene with fractional channels), the output
+  // waits for the transfer of the previous frame, so the median is the shortest frame time
+  LightScene Scene = BenchmarkScene;
+  Scene.Value[LightBrightness] = 7;
+  LEDColorControl(Scene);
+  BenchmarkRun("LEDStripShowFrames", PixelCount, 0, 0, [](int i) {
+    LEDStripShowFrames(LEDFrameBuffer, true);
+  });
+  uint32_t BudgetNanos = (uint32_t)DitherFrameMillis * 1000000;
+  uint32_t P99 = BenchmarkSample[BenchmarkIterations * 99 / 100];
+  Serial.printf("BENCH {\"headroom\":\"LEDStripShowFrames\",\"frame_budget_ns\":%u,\"p99_ns\":%u,"
+                "\"headroom_ns\":%d,\"headroom_percent\":%d}\n",
+                (unsigned)BudgetNanos, (unsigned)P99, (int)(BudgetNanos - P99),
+                BudgetNanos > 0 ? (int)(((int64_t)BudgetNanos - P99) * 100 / BudgetNanos) : 0);
+  BenchmarkRenderPathDone = true;
+}
+
+// Benchmark - deliver one MQTT command of this device like 'PubSubClient' (writable topic
+// '<prefix>/set/<TopicName>', payload not terminated)
+static void BenchmarkMessage(const char* TopicName, const char* Message) {
+  static char Topic[96];
+  static byte Payload[128];
+  size_t Length = strlen(Message);
+  snprintf(Topic, sizeof(Topic), "%s/%s", MQTTCommandPrefix, TopicName);
+  memcpy(Payload, Message, Length);
+  MQTTCallback(Topic, Payload, Length);
+}
+
+// Benchmark - configuration path ('MQTTCallback()', 'NVSReadSettings()'), called by 'loop()'
+void BenchmarkConfigPathService(bool isTimeSynced) {
+  static bool isDone = false;
+  if (isDone || !isTimeSynced || !BenchmarkRenderPathDone) {
+    return;
+  }
+  isDone = true;
+  Serial.printf("BENCH {\"start\":\"config\",\"log_level\":%d}\n", LOG_LEVEL);
+  // the benchmark changes settings, they are restored afterwards
+  static int32_t Saved[SettingCount];
+  memcpy(Saved, Settings.Value, sizeof(Saved));
+  // alternating values, so that every message is a change
+  BenchmarkRun("MQTTCallback/LEDBrightness", 0, 0, 0, [](int i) {
+    BenchmarkMessage("LEDBrightness", i & 1 ? "71" : "70");
+  });
+  BenchmarkRun("MQTTCallback/LEDColorTop", 0, 0, 0, [](int i) {
+    BenchmarkMessage("LEDColorTop", i & 1 ? "[  0,193,254]" : "[  0,193,255]");
+  });
+  BenchmarkRun("MQTTCallback/Config", 0, 0, 0, [](int i) {
+    BenchmarkMessage("Config", i & 1 ? "LEDBrightness=71;LEDAmplifier=10;LEDColorTop=[  0,193,254];LEDColorWhite=60"
+                                     : "LEDBrightness=70;LEDAmplifier=0;LEDColorTop=[  0,193,255];LEDColorWhite=70");
+  });
+  BenchmarkRun("MQTTCallback/Unknown", 0, 0, 0, [](int i) {
+    BenchmarkMessage("LEDUnknownTopic", "1");
+  });
+  BenchmarkRun("NVSReadSettings", 0, 0, 0, [](int i) {
+    NVSReadSettings(false, true);
+  });
+  // phase transitions of two days after a change of the rules (weekend, holidays, acclimation)
+  static PhaseRules Rules;
+  static PhaseSchedule Schedule;
+  const char* RulesMessage = "67,*,*,10:00,23:15;*,12-24,01-02,11:00,1:30;*,2026-11-01,2026-11-14,12:00,18:00";
+  PhaseRulesParse(RulesMessage, strlen(RulesMessage), Rules);
+  time_t Start = time(nullptr);
+  BenchmarkRun("PhaseScheduleCompile", 0, 0, 0, [&](int i) {
+    PhaseScheduleCompile(Schedule, Rules, 540, 1350 + (i & 1), Start, 0);
+  });
+  // one simulated year, one step per deadline like the phase timer
+  int64_t Micros = 0;
+  time_t Now = Start;
+  int Changes = 0;
+  uint32_t SimulationStart = BenchmarkNow();
+  PhaseScheduleCompile(Schedule, Rules, 540, 1350, Now, Micros);
+  while (Now < Start + 365 * 86400) {
+    int64_t Delay = Schedule.DeadlineMicros - Micros;
+    Micros += Delay;
+    Now += (time_t)(Delay / 1000000);
+    Changes += PhaseScheduleAdvance(Schedule, Rules, 540, 1350, Now, Micros) ? 1 : 0;
+  }
+  Serial.printf("BENCH {\"simulation\":\"PhaseSchedule\",\"days\":365,\"transitions\":%d,\"elapsed_ns\":%u}\n",
+                Changes, (unsigned)BenchmarkNanos(SimulationStart, BenchmarkNow()));
+  for (int i = 0; i < SettingCount; ++i) {
+    SettingsStoreSet(Settings, i, Saved[i], millis());
+  }
+  NVSReadSettings(true, true);
+  LEDColorControl();
+  Serial.printf("BENCH {\"summary\":true,\"cases\":%d,\"failed\":%d}\n", BenchmarkCases, BenchmarkFailed.load());
+#ifndef ESP_PLATFORM
+  fflush(stdout);
+  // exit code: number of failed cases (at most 255)
+  exit(BenchmarkFailed > 255 ? 255 : BenchmarkFailed.load());
+#endif
+}
+
+#endif
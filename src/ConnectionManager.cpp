@@ -0,0 +1,139 @@
+// -------------------------------------------------------------------
+// Connection manager - non-blocking state machine for WiFi, NTP and MQTT
+// -------------------------------------------------------------------
+
+#include <ConnectionManager.h>
+
+// Connection manager - enter a new state and run its entry action
+static void ConnectionEnter(Connection& Link, const ConnectionHooks& Hooks, ConnectionState State,
+                            uint32_t WaitMillis, uint32_t Now) {
+  Link.State = State;
+  Link.StateMillis = Now;
+  Link.WaitMillis = WaitMillis;
+  if (State == ConnectionWiFiConnecting) {
+    Hooks.WiFiBegin();
+  }
+  else if (State == ConnectionNTPSyncing) {
+    Hooks.NTPBegin();
+  }
+  else if (State == ConnectionOnline) {
+    Link.Attempts = 0;
+    Hooks.Online();
+  }
+}
+
+// Connection manager - wait with jittered exponential backoff, then retry 'RetryState'
+static void ConnectionRetry(Connection& Link, const ConnectionHooks& Hooks, const ConnectionTimings& Timings,
+                            ConnectionState RetryState, uint32_t Now) {
+  Link.RetryState = RetryState;
+  uint32_t Delay = ConnectionJitterMillis(Link, Timings, ConnectionBackoffMillis(Timings, Link.Attempts));
+  ConnectionEnter(Link, Hooks, ConnectionBackoff, Delay, Now);
+  if (Link.Attempts < 31) {
+    Link.Attempts++;
+  }
+}
+
+// Connection manager - WiFi is connected, continue with the time (once) and MQTT
+static void ConnectionWiFiReady(Connection& Link, const ConnectionHooks& Hooks, const ConnectionTimings& Timings, uint32_t Now) {
+  Link.Attempts = 0;
+  if (Link.isTimeSynced) {
+    ConnectionEnter(Link, Hooks, ConnectionMQTTConnecting, 0, Now);
+  }
+  else {
+    ConnectionEnter(Link, Hooks, ConnectionNTPSyncing, Timings.NTPTimeoutMillis, Now);
+  }
+}
+
+// Connection manager - WiFi event (got IP / disconnected), safe to call from the WiFi task
+void ConnectionNotifyWiFi(Connection& Link, bool isConnected) {
+  Link.isWiFiConnected = isConnected;
+}
+
+// Connection manager - backoff delay after 'Attempts' failed attempts
+uint32_t ConnectionBackoffMillis(const ConnectionTimings& Timings, uint8_t Attempts) {
+  uint32_t Delay = Timings.BackoffMinMillis;
+  while (Attempts-- > 0 && Delay < Timings.BackoffMaxMillis) {
+    Delay *= 2;
+  }
+  return Delay > Timings.BackoffMaxMillis ? Timings.BackoffMaxMillis : Delay;
+}
+
+// Connection manager - backoff delay with jitter, advances the random state of 'Link'
+uint32_t ConnectionJitterMillis(Connection& Link, const ConnectionTimings& Timings, uint32_t Delay) {
+  uint32_t Jitter = (uint32_t)((uint64_t)Delay * Timings.BackoffJitterPercent / 100);
+  if (Jitter == 0) {
+    return Delay;
+  }
+  // xorshift32, enough to spread the retries of several devices
+  uint32_t Random = Link.JitterState != 0 ? Link.JitterState : 1;
+  Random ^= Random << 13;
+  Random ^= Random >> 17;
+  Random ^= Random << 5;
+  Link.JitterState = Random;
+  return Delay - Random % (Jitter + 1);
+}
+
+// Connection manager - advance the state machine, never blocks (except for one 'MQTTConnect')
+void ConnectionUpdate(Connection& Link, const ConnectionHooks& Hooks, const ConnectionTimings& Timings, uint32_t Now) {
+  uint32_t Elapsed = Now - Link.StateMillis;
+  // a lost WiFi connection restarts everything behind it
+  if (!Link.isWiFiConnected && Link.State != ConnectionIdle && Link.State != ConnectionWiFiConnecting &&
+      !(Link.State == ConnectionBackoff && Link.RetryState == ConnectionWiFiConnecting)) {
+    Link.ReconnectCount++;
+    Link.Attempts = 0;
+    ConnectionEnter(Link, Hooks, ConnectionWiFiConnecting, Timings.WiFiTimeoutMillis, Now);
+    return;
+  }
+  switch (Link.State) {
+    case ConnectionIdle:
+      ConnectionEnter(Link, Hooks, ConnectionWiFiConnecting, Timings.WiFiTimeoutMillis, Now);
+      break;
+    case ConnectionWiFiConnecting:
+      if (Link.isWiFiConnected) {
+        ConnectionWiFiReady(Link, Hooks, Timings, Now);
+      }
+      else if (Elapsed >= Link.WaitMillis) {
+        ConnectionRetry(Link, Hooks, Timings, ConnectionWiFiConnecting, Now);
+      }
+      break;
+    case ConnectionNTPSyncing:
+      // without a time server the MQTT connection is established anyway,
+      // the synchronization keeps running in the background
+      if (Hooks.NTPIsSynced()) {
+        Link.isTimeSynced = true;
+        ConnectionEnter(Link, Hooks, ConnectionMQTTConnecting, 0, Now);
+      }
+      else if (Elapsed >= Link.WaitMillis) {
+        ConnectionEnter(Link, Hooks, ConnectionMQTTConnecting, 0, Now);
+      }
+      break;
+    case ConnectionMQTTConnecting:
+      if (Hooks.MQTTConnect()) {
+        ConnectionEnter(Link, Hooks, ConnectionOnline, 0, Now);
+      }
+      else {
+        ConnectionRetry(Link, Hooks, Timings, ConnectionMQTTConnecting, Now);
+      }
+      break;
+    case ConnectionOnline:
+      if (!Link.isTimeSynced && Hooks.NTPIsSynced()) {
+        Link.isTimeSynced = true;
+        Hooks.Online();
+      }
+      if (!Hooks.MQTTIsConnected()) {
+        Link.ReconnectCount++;
+        ConnectionEnter(Link, Hooks, ConnectionMQTTConnecting, 0, Now);
+      }
+      break;
+    case ConnectionBackoff:
+      // the WiFi may connect on its own while waiting
+      if (Link.RetryState == ConnectionWiFiConnecting && Link.isWiFiConnected) {
+        ConnectionWiFiReady(Link, Hooks, Timings, Now);
+      }
+      else if (Elapsed >= Link.WaitMillis) {
+        uint32_t WaitMillis = Link.RetryState == ConnectionWiFiConnecting ? Timings.WiFiTimeoutMillis : 0;
+        ConnectionEnter(Link, Hooks, Link.RetryState, WaitMillis, Now);
+      }
+      break;
+  }
+}
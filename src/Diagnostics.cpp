@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------
+// Diagnostics - runtime counters, published periodically as JSON ('-D DIAGNOSTICS=1')
+// -------------------------------------------------------------------
+
+#include <Diagnostics.h>
+
+#if DIAGNOSTICS
+
+#include <Log.h>
+#include <EventLoop.h>
+#include <stdio.h>
+
+DiagnosticsCounters Diagnostics;
+
+// start of the current interval and uptime, wrap-safe beyond the 49 days of 'millis()'
+static uint32_t DiagnosticsIntervalStart = 0;
+static uint64_t DiagnosticsUptimeMillis = 0;
+#if EVENT_LOOP
+// event loop times at the start of the current interval
+static uint64_t DiagnosticsActiveMicros = 0;
+static uint64_t DiagnosticsIdleMicros = 0;
+static uint32_t DiagnosticsWakeups = 0;
+static uint32_t DiagnosticsFrameLockMillis = 0;
+#endif
+
+// Diagnostics - format the report as JSON and start the next interval
+int DiagnosticsFormat(char* Buffer, size_t Size, uint32_t Now, uint32_t NVSWriteCount, uint32_t ReconnectCount) {
+  uint32_t Elapsed = Now - DiagnosticsIntervalStart;
+  DiagnosticsIntervalStart = Now;
+  DiagnosticsUptimeMillis += Elapsed;
+  // interval values, the writer ('loop()') is the caller, so they can be reset here
+  uint32_t Loops = Diagnostics.LoopCount.load(std::memory_order_relaxed);
+  uint32_t MQTTLoops = Diagnostics.MQTTLoopCount.load(std::memory_order_relaxed);
+  uint32_t MQTTTotal = Diagnostics.MQTTLoopTotalMicros.load(std::memory_order_relaxed);
+  uint32_t MQTTMax = Diagnostics.MQTTLoopMaxMicros.load(std::memory_order_relaxed);
+  Diagnostics.LoopCount.store(0, std::memory_order_relaxed);
+  Diagnostics.MQTTLoopCount.store(0, std::memory_order_relaxed);
+  Diagnostics.MQTTLoopTotalMicros.store(0, std::memory_order_relaxed);
+  Diagnostics.MQTTLoopMaxMicros.store(0, std::memory_order_relaxed);
+  uint32_t LoopsPerSecond = Elapsed > 0 ? (uint32_t)((uint64_t)Loops * 1000 / Elapsed) : 0;
+  uint32_t MQTTAverage = MQTTLoops > 0 ? MQTTTotal / MQTTLoops : 0;
+  int Length = snprintf(Buffer, Size,
+                        "{\"uptime_s\":%u,\"loops_per_s\":%u,\"mqtt_loop_max_us\":%u,\"mqtt_loop_avg_us\":%u,"
+                        "\"renders\":%u,\"render_us\":%u,\"shows_skipped\":%u,\"nvs_writes\":%u,\"heap_free\":%u,"
+                        "\"heap_min\":%u,\"heap_max_block\":%u,\"reconnects\":%u,\"log_dropped\":%u}",
+                        (unsigned)(DiagnosticsUptimeMillis / 1000), (unsigned)LoopsPerSecond, (unsigned)MQTTMax,
+                        (unsigned)MQTTAverage, (unsigned)Diagnostics.RenderCount.load(std::memory_order_relaxed),
+                        (unsigned)Diagnostics.RenderMicros.load(std::memory_order_relaxed),
+                        (unsigned)Diagnostics.ShowSkipCount.load(std::memory_order_relaxed), (unsigned)NVSWriteCount,
+                        (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap(),
+                        (unsigned)ReconnectCount, (unsigned)LogDroppedCount());
+  if (Length < 0 || (size_t)Length >= Size) {
+    return -1;
+  }
+#if EVENT_LOOP
+  // active and sleeping time of 'loop()' and the time the render task blocked light sleep in this
+  // interval, appended to the object
+  uint32_t ActiveMillis = (uint32_t)((EventLoop.ActiveMicros - DiagnosticsActiveMicros) / 1000);
+  uint32_t IdleMillis = (uint32_t)((EventLoop.IdleMicros - DiagnosticsIdleMicros) / 1000);
+  // a lock held right now counts up to 'Now', the rest of the hold goes to the next interval
+  uint32_t FrameLockMillis = EventLoopFrameLockTotal(Now);
+  DiagnosticsActiveMicros = EventLoop.ActiveMicros;
+  DiagnosticsIdleMicros = EventLoop.IdleMicros;
+  uint32_t Wakeups = EventLoop.Wakeups - DiagnosticsWakeups;
+  DiagnosticsWakeups = EventLoop.Wakeups;
+  uint32_t FrameLockInterval = FrameLockMillis - DiagnosticsFrameLockMillis;
+  DiagnosticsFrameLockMillis = FrameLockMillis;
+  uint32_t Total = ActiveMillis + IdleMillis;
+  int Extra = snprintf(Buffer + Length - 1, Size - Length + 1,
+                       ",\"light_sleep\":%d,\"active_ms\":%u,\"idle_ms\":%u,\"idle_percent\":%u,\"wakeups\":%u,"
+                       "\"frame_lock_ms\":%u}",
+                       EventLoop.isLightSleep ? 1 : 0, (unsigned)ActiveMillis, (unsigned)IdleMillis,
+                       Total > 0 ? (unsigned)((uint64_t)IdleMillis * 100 / Total) : 0, (unsigned)Wakeups,
+                       (unsigned)FrameLockInterval);
+  if (Extra < 0 || (size_t)(Length - 1 + Extra) >= Size) {
+    return -1;
+  }
+  Length += Extra - 1;
+#endif
+  return Length;
+}
+
+#endif
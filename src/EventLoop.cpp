@@ -0,0 +1,158 @@
+// -------------------------------------------------------------------
+// Event loop - the network/config task sleeps on an event group, automatic light sleep while idle
+// ('-D EVENT_LOOP=1')
+// -------------------------------------------------------------------
+
+#include <EventLoop.h>
+
+#if EVENT_LOOP
+
+#include <Arduino.h>
+#include <Log.h>
+#include <freertos/event_groups.h>
+#include <esp_pm.h>
+#include <sys/select.h>
+
+EventLoopStats EventLoop;
+
+// internal event: 'loop()' read the socket, the watcher may watch it again
+static const uint32_t EventLoopSocketFree = 0x80;
+// the watcher looks for a new socket and 'loop()' for a lost signal in this interval
+static const uint32_t EventLoopWatcherIdleMillis = 1000;
+
+static EventGroupHandle_t EventLoopGroup = nullptr;
+static std::atomic<int> EventLoopSocket{-1};
+static uint32_t EventLoopWaitEndMicros = 0;             // 'loop()' only
+static esp_pm_lock_handle_t EventLoopFrameLockHandle = nullptr;
+// written by the render task only, read by 'EventLoopFrameLockTotal()'
+static std::atomic<bool> EventLoopIsFrameLocked{false};
+static std::atomic<uint32_t> EventLoopFrameLockStartMillis{0};
+
+// Event loop - task that blocks in 'select()' on the MQTT socket and signals readable data
+static void EventLoopWatcherTask(void* Parameter) {
+  for (;;) {
+    int Socket = EventLoopSocket.load(std::memory_order_relaxed);
+    if (Socket < 0) {
+      vTaskDelay(pdMS_TO_TICKS(EventLoopWatcherIdleMillis));
+      continue;
+    }
+    fd_set Readable;
+    FD_ZERO(&Readable);
+    FD_SET(Socket, &Readable);
+    struct timeval Timeout = {EventLoopWatcherIdleMillis / 1000, 0};
+    int Ready = select(Socket + 1, &Readable, nullptr, nullptr, &Timeout);
+    if (Ready > 0) {
+      // the data stays readable until 'loop()' read it, so wait for that before the next 'select()'
+      xEventGroupClearBits(EventLoopGroup, EventLoopSocketFree);
+      xEventGroupSetBits(EventLoopGroup, EventLoopNetwork);
+      xEventGroupWaitBits(EventLoopGroup, EventLoopSocketFree, pdTRUE, pdTRUE, pdMS_TO_TICKS(EventLoopWatcherIdleMillis));
+    }
+    else if (Ready < 0) {
+      // socket closed in between, 'loop()' passes the next one
+      vTaskDelay(pdMS_TO_TICKS(EventLoopWatcherIdleMillis));
+    }
+  }
+}
+
+// Event loop - create the event group and the socket watcher, enable automatic light sleep
+bool EventLoopBegin(bool isLightSleep, uint32_t WatcherStackSize, uint32_t WatcherPriority, int WatcherCore) {
+  EventLoopGroup = xEventGroupCreate();
+  xTaskCreatePinnedToCore(EventLoopWatcherTask, "EventLoopWatcher", WatcherStackSize, nullptr, WatcherPriority,
+                          nullptr, WatcherCore);
+  EventLoopWaitEndMicros = micros();
+  if (!isLightSleep) {
+    return false;
+  }
+  // light sleep needs power management and tickless idle in the SDK configuration
+  esp_pm_config_esp32_t Config = {};
+  Config.max_freq_mhz = ESP.getCpuFreqMHz();
+  Config.min_freq_mhz = 80;
+  Config.light_sleep_enable = true;
+  esp_err_t Result = esp_pm_configure(&Config);
+  if (Result != ESP_OK) {
+    LOG_WARN("Power / automatic light sleep not available (error 0x%x), waiting without it\n", (unsigned)Result);
+    return false;
+  }
+  esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "LEDFrame", &EventLoopFrameLockHandle);
+  EventLoop.isLightSleep = true;
+  LOG_INFO("Power / automatic light sleep enabled\n");
+  return true;
+}
+
+// Event loop - signal events to 'loop()'
+void EventLoopSet(uint32_t Events) {
+  if (EventLoopGroup != nullptr) {
+    xEventGroupSetBits(EventLoopGroup, Events);
+  }
+}
+
+// Event loop - wait for events at most 'TimeoutMillis', returns the events (0 = timeout)
+uint32_t EventLoopWait(uint32_t TimeoutMillis) {
+  uint32_t Start = micros();
+  EventLoop.ActiveMicros += Start - EventLoopWaitEndMicros;
+  uint32_t Events = xEventGroupWaitBits(EventLoopGroup, EventLoopNetwork | EventLoopPhase | EventLoopWake,
+                                        pdTRUE, pdFALSE, pdMS_TO_TICKS(TimeoutMillis));
+  Events &= EventLoopNetwork | EventLoopPhase | EventLoopWake;
+  EventLoopWaitEndMicros = micros();
+  EventLoop.IdleMicros += EventLoopWaitEndMicros - Start;
+  if (Events != 0) {
+    EventLoop.Wakeups++;
+  }
+  return Events;
+}
+
+// Event loop - MQTT socket to watch (-1 = none)
+void EventLoopWatchSocket(int Socket) {
+  EventLoopSocket.store(Socket, std::memory_order_relaxed);
+}
+
+// Event loop - the data of the last signal was read
+void EventLoopSocketRead() {
+  xEventGroupSetBits(EventLoopGroup, EventLoopSocketFree);
+}
+
+// Event loop - the render task outputs frames or goes idle
+void EventLoopFrameLock(bool isActive) {
+  if (isActive == EventLoopIsFrameLocked.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // the start is written before the lock shows as held, the hold is added after it shows as released,
+  // so 'EventLoopFrameLockTotal()' never counts a hold twice
+  if (isActive) {
+    EventLoopFrameLockStartMillis.store(millis(), std::memory_order_relaxed);
+    EventLoopIsFrameLocked.store(true, std::memory_order_release);
+  }
+  else {
+    uint32_t Held = millis() - EventLoopFrameLockStartMillis.load(std::memory_order_relaxed);
+    EventLoopIsFrameLocked.store(false, std::memory_order_release);
+    EventLoop.FrameLockMillis.store(EventLoop.FrameLockMillis.load(std::memory_order_relaxed) + Held,
+                                    std::memory_order_release);
+  }
+  if (EventLoopFrameLockHandle != nullptr) {
+    if (isActive) {
+      esp_pm_lock_acquire(EventLoopFrameLockHandle);
+    }
+    else {
+      esp_pm_lock_release(EventLoopFrameLockHandle);
+    }
+  }
+}
+
+// Event loop - time the frame lock was held since the start including the current hold (any task)
+uint32_t EventLoopFrameLockTotal(uint32_t Now) {
+  for (;;) {
+    uint32_t Total = EventLoop.FrameLockMillis.load(std::memory_order_acquire);
+    bool isLocked = EventLoopIsFrameLocked.load(std::memory_order_acquire);
+    uint32_t Start = EventLoopFrameLockStartMillis.load(std::memory_order_relaxed);
+    // a release in between added the hold to the total, read again
+    if (EventLoop.FrameLockMillis.load(std::memory_order_acquire) != Total) {
+      continue;
+    }
+    if (isLocked && (int32_t)(Now - Start) > 0) {
+      Total += Now - Start;
+    }
+    return Total;
+  }
+}
+
+#endif
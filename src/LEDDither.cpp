@@ -0,0 +1,14 @@
+// -------------------------------------------------------------------
+// LED dither - temporal dithering of the 8.8 frame channels to the 8 bits of the strip
+// -------------------------------------------------------------------
+
+#include <LEDDither.h>
+
+// LED dither - start values of the residuals, spread over the pixels
+void LEDDitherReset(LEDDitherState& State) {
+  for (int i = 0; i < LEDCurveMaxPixels; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      State.Error[i][c] = (uint8_t)(i * 97 + c * 61);
+    }
+  }
+}
@@ -0,0 +1,41 @@
+// -------------------------------------------------------------------
+// LED gradient - curve engine and frame buffer
+// -------------------------------------------------------------------
+
+#include <LEDGradient.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// LED gradient - exponential share of 'LEDAmplifierY' (fast for 'Amplifier' >= 0, slow below) for pixel 1..PixelCount
+double LEDCurveShape(int Pixel, int PixelCount, int Amplifier, int TauThousand) {
+  float LEDTau = TauThousand / 1000.0;
+  if (Amplifier >= 0) {
+    return 1 - exp((-Pixel + 1) / LEDTau);
+  }
+  // exp(Pixel / Tau) / exp(PixelCount / Tau) in one exponent, the factors overflow for small 'Tau'
+  return exp((double)(Pixel - PixelCount) / LEDTau);
+}
+
+// LED gradient - reference value of 'LEDAmplifierY' in double precision for pixel 1..PixelCount
+double LEDCurveReference(int Pixel, int PixelCount, int Amplifier, int TauThousand) {
+  // the first pixel shows the bottom color, the last pixel the top color
+  if (Pixel <= 1) {
+    return 0.0;
+  }
+  if (Pixel >= PixelCount) {
+    return 1.0;
+  }
+  double LEDAmplifierYShape = LEDCurveShape(Pixel, PixelCount, Amplifier, TauThousand);
+  double LEDAmplifierYLinear = (1.0 / (PixelCount - 1)) * Pixel - (1.0 / (PixelCount - 1));
+  return LEDAmplifierYShape * abs(Amplifier) / 100 + LEDAmplifierYLinear * (100 - abs(Amplifier)) / 100;
+}
+
+// LED frame - set all pixels to '0'
+void LEDFrameClear(LEDFrame& Frame, int PixelCount) {
+  if (PixelCount > LEDCurveMaxPixels) {
+    PixelCount = LEDCurveMaxPixels;
+  }
+  Frame.PixelCount = PixelCount;
+  memset(Frame.Pixel, 0, sizeof(LEDPixel) * PixelCount);
+}
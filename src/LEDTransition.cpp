@@ -0,0 +1,59 @@
+// -------------------------------------------------------------------
+// LED transition - non-blocking cross-fade between two frames
+// -------------------------------------------------------------------
+
+#include <LEDTransition.h>
+#include <string.h>
+
+// LED frame - integer lerp of every channel, 'Weight' 0..LEDCurveOne = 'From'..'To'
+void LEDFrameLerp(LEDFrame& Frame, const LEDFrame& From, const LEDFrame& To, int32_t Weight) {
+  // internal lambda function for one channel ('Weight' reduced to Q15, so that the product fits into 32 bits)
+  auto Lerp = [Weight](int A, int B) -> uint16_t {
+    return static_cast<uint16_t>(A + (((int32_t)(B - A) * (Weight >> 1)) >> (LEDCurveFractionBits - 1)));
+  };
+  Frame.PixelCount = To.PixelCount;
+  for (int i = 0; i < To.PixelCount; ++i) {
+    Frame.Pixel[i].R = Lerp(From.Pixel[i].R, To.Pixel[i].R);
+    Frame.Pixel[i].G = Lerp(From.Pixel[i].G, To.Pixel[i].G);
+    Frame.Pixel[i].B = Lerp(From.Pixel[i].B, To.Pixel[i].B);
+    Frame.Pixel[i].W = Lerp(From.Pixel[i].W, To.Pixel[i].W);
+  }
+}
+
+// LED transition - start a cross-fade from 'From' to 'To' at time 'Now' (ms)
+void LEDTransitionStart(LEDTransition& Transition, const LEDFrame& From, const LEDFrame& To,
+                        uint32_t Now, uint32_t DurationMillis) {
+  // a frame with a different pixel count (e.g. nothing shown yet) fades in from black
+  if (From.PixelCount != To.PixelCount) {
+    LEDFrameClear(Transition.From, To.PixelCount);
+  }
+  else {
+    memcpy(&Transition.From, &From, sizeof(LEDFrame));
+  }
+  memcpy(&Transition.To, &To, sizeof(LEDFrame));
+  Transition.StartMillis = Now;
+  Transition.DurationMillis = DurationMillis;
+  Transition.LastFrameMillis = Now;
+  Transition.isActive = true;
+}
+
+// LED transition - compute the next frame if 'FrameMillis' elapsed since the last one,
+// returns true if 'Frame' was updated (the last frame equals the target and ends the transition)
+bool LEDTransitionStep(LEDTransition& Transition, LEDFrame& Frame, uint32_t Now, uint32_t FrameMillis) {
+  if (!Transition.isActive) {
+    return false;
+  }
+  uint32_t Elapsed = Now - Transition.StartMillis;
+  if (Elapsed >= Transition.DurationMillis) {
+    memcpy(&Frame, &Transition.To, sizeof(LEDFrame));
+    Transition.isActive = false;
+    return true;
+  }
+  if (Now - Transition.LastFrameMillis < FrameMillis) {
+    return false;
+  }
+  Transition.LastFrameMillis = Now;
+  int32_t Weight = static_cast<int32_t>(((uint64_t)Elapsed << LEDCurveFractionBits) / Transition.DurationMillis);
+  LEDFrameLerp(Frame, Transition.From, Transition.To, Weight);
+  return true;
+}
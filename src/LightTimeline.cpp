@@ -0,0 +1,138 @@
+// -------------------------------------------------------------------
+// Light timeline - keyframes with a full LED parameter set per day
+// -------------------------------------------------------------------
+
+#include <LightTimeline.h>
+#include <ParseInteger.h>
+#include <stdio.h>
+#include <string.h>
+
+// valid range of every scene value
+static const int16_t LightSceneMin[LightSceneValueCount] = {0,   0, -100,     1,   0,   0,   0,   0,   0,   0,   0};
+static const int16_t LightSceneMax[LightSceneValueCount] = {1, 100,  100, 32767, 255, 255, 255, 255, 255, 255, 100};
+
+// Light timeline - index of the keyframe active at 'Minute' (binary search), -1 if empty
+int LightTimelineFind(const LightTimeline& Timeline, int Minute) {
+  if (Timeline.Count == 0) {
+    return -1;
+  }
+  // last keyframe with 'Minute' <= 'Minute'
+  int Low = 0;
+  int High = Timeline.Count;
+  while (Low < High) {
+    int Middle = (Low + High) / 2;
+    if (Timeline.Keyframe[Middle].Minute <= Minute) {
+      Low = Middle + 1;
+    }
+    else {
+      High = Middle;
+    }
+  }
+  // before the first keyframe the last one of the previous day is still active
+  return Low == 0 ? Timeline.Count - 1 : Low - 1;
+}
+
+// Light timeline - interpolated scene at 'Second' of the day (0..86399), false if empty
+bool LightTimelineEvaluate(const LightTimeline& Timeline, int32_t Second, LightScene& Scene) {
+  int Index = LightTimelineFind(Timeline, Second / 60);
+  if (Index < 0) {
+    return false;
+  }
+  const LightKeyframe& From = Timeline.Keyframe[Index];
+  const LightKeyframe& To = Timeline.Keyframe[(Index + 1) % Timeline.Count];
+  // distance between both keyframes and elapsed time, both across midnight
+  int32_t Span = ((int32_t)To.Minute - From.Minute + 1440) % 1440 * 60;
+  if (Span == 0) {
+    Span = 86400;
+  }
+  int32_t Elapsed = (Second - (int32_t)From.Minute * 60 + 86400) % 86400;
+  int32_t Weight = static_cast<int32_t>(((int64_t)Elapsed << 16) / Span);
+  Scene.Value[LightStatus] = From.Scene.Value[LightStatus];
+  for (int i = LightStatus + 1; i < LightSceneValueCount; ++i) {
+    int32_t Delta = (int32_t)To.Scene.Value[i] - From.Scene.Value[i];
+    Scene.Value[i] = static_cast<int16_t>(From.Scene.Value[i] + ((Delta * Weight + 32768) >> 16));
+  }
+  return true;
+}
+
+// Light timeline - parse "H:MM,v1,..,v11;H:MM,.." (empty = no keyframes), false on invalid input
+bool LightTimelineParse(const char* Message, unsigned int MessageLength, LightTimeline& Timeline) {
+  LightTimeline Parsed;
+  unsigned int i = 0;
+  while (i < MessageLength) {
+    if (Parsed.Count == LightTimelineMaxKeyframes) {
+      return false;
+    }
+    LightKeyframe Keyframe;
+    int Hours;
+    int Minutes;
+    // time 'H:MM'
+    if (!ParseInteger(Message, MessageLength, i, 5, true, Hours) || i >= MessageLength || Message[i] != ':') {
+      return false;
+    }
+    i++;
+    if (!ParseInteger(Message, MessageLength, i, 5, true, Minutes) ||
+        Hours < 0 || Hours > 23 || Minutes < 0 || Minutes > 59) {
+      return false;
+    }
+    Keyframe.Minute = Hours * 60 + Minutes;
+    // scene values, each preceded by ','
+    for (int k = 0; k < LightSceneValueCount; ++k) {
+      int Value;
+      if (i >= MessageLength || Message[i] != ',') {
+        return false;
+      }
+      i++;
+      if (!ParseInteger(Message, MessageLength, i, 5, true, Value) ||
+          Value < LightSceneMin[k] || Value > LightSceneMax[k]) {
+        return false;
+      }
+      Keyframe.Scene.Value[k] = Value;
+    }
+    // keyframes are separated by ';'
+    if (i < MessageLength) {
+      if (Message[i] != ';') {
+        return false;
+      }
+      i++;
+    }
+    // insert sorted by time, an identical time replaces the existing keyframe
+    int Position = Parsed.Count;
+    while (Position > 0 && Parsed.Keyframe[Position - 1].Minute > Keyframe.Minute) {
+      Position--;
+    }
+    if (Position > 0 && Parsed.Keyframe[Position - 1].Minute == Keyframe.Minute) {
+      Parsed.Keyframe[Position - 1] = Keyframe;
+      continue;
+    }
+    memmove(&Parsed.Keyframe[Position + 1], &Parsed.Keyframe[Position], sizeof(LightKeyframe) * (Parsed.Count - Position));
+    Parsed.Keyframe[Position] = Keyframe;
+    Parsed.Count++;
+  }
+  Timeline = Parsed;
+  return true;
+}
+
+// Light timeline - format as 'Timeline' message, returns the length without terminator
+int LightTimelineFormat(const LightTimeline& Timeline, char* Buffer, int BufferSize) {
+  int Length = 0;
+  if (BufferSize > 0) {
+    Buffer[0] = '\0';
+  }
+  for (int k = 0; k < Timeline.Count; ++k) {
+    const LightKeyframe& Keyframe = Timeline.Keyframe[k];
+    const int16_t* Value = Keyframe.Scene.Value;
+    int Written = snprintf(Buffer + Length, BufferSize - Length,
+                           "%s%d:%02d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+                           k == 0 ? "" : ";", Keyframe.Minute / 60, Keyframe.Minute % 60,
+                           Value[0], Value[1], Value[2], Value[3], Value[4], Value[5],
+                           Value[6], Value[7], Value[8], Value[9], Value[10]);
+    if (Written < 0 || Written >= BufferSize - Length) {
+      // buffer too small, output truncated to complete keyframes
+      Buffer[Length] = '\0';
+      break;
+    }
+    Length += Written;
+  }
+  return Length;
+}
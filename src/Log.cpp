@@ -0,0 +1,118 @@
+// -------------------------------------------------------------------
+// Log - level-filtered logging over a lock-free ring buffer
+// -------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <Log.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <atomic>
+
+// one line of the ring buffer, 'Sequence' tells producers and the consumer whose turn it is:
+// 'LogRound(Position)' = free for the producer, + 1 = written, + 'LogRingSize' = free for the next round
+struct LogLine {
+  std::atomic<uint32_t> Sequence;
+  uint16_t Length;
+  char Text[LogLineSize];
+};
+
+// bounded ring for any number of producers (tasks on both cores) and one consumer (the log task),
+// zero-initialized it is empty, so lines can be written before 'LogBegin()'
+static LogLine LogRing[LogRingSize];
+static std::atomic<uint32_t> LogTail{0}; // next line to write, shared by the producers
+static uint32_t LogHead = 0;             // next line to read, consumer only
+static std::atomic<uint32_t> LogDropped{0};
+static uint32_t LogDroppedReported = 0;
+static TaskHandle_t LogTaskHandle = nullptr;
+
+// Log - first position of the round of 'Position'
+static inline uint32_t LogRound(uint32_t Position) {
+  return Position & ~(LogRingSize - 1);
+}
+
+// Log - task that writes the buffered lines, sleeps until a line is written or dropped (every
+// 'LogWrite()' notifies it, no periodic wake-up, which would keep the chip out of light sleep)
+static void LogTask(void* Parameter) {
+  for (;;) {
+    LogFlush();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+// Log - start the task that writes the buffered lines to the serial interface
+void LogBegin(uint32_t StackSize, uint32_t Priority, int Core) {
+  xTaskCreatePinnedToCore(LogTask, "Log", StackSize, nullptr, Priority, &LogTaskHandle, Core);
+}
+
+// Log - format one line into the ring buffer (never waits, the line is dropped if the buffer is full)
+void LogWrite(const char* Format, ...) {
+  // reserve a line
+  uint32_t Position = LogTail.load(std::memory_order_relaxed);
+  LogLine* Line;
+  for (;;) {
+    Line = &LogRing[Position & (LogRingSize - 1)];
+    int32_t Distance = (int32_t)(Line->Sequence.load(std::memory_order_acquire) - LogRound(Position));
+    if (Distance == 0) {
+      if (LogTail.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    else if (Distance < 0) {
+      LogDropped.fetch_add(1, std::memory_order_relaxed);
+      if (LogTaskHandle != nullptr) {
+        xTaskNotifyGive(LogTaskHandle);
+      }
+      return;
+    }
+    else {
+      Position = LogTail.load(std::memory_order_relaxed);
+    }
+  }
+  va_list Arguments;
+  va_start(Arguments, Format);
+  int Length = vsnprintf(Line->Text, LogLineSize, Format, Arguments);
+  va_end(Arguments);
+  if (Length < 0) {
+    Length = 0;
+  }
+  // a truncated line still ends with a line break
+  if (Length >= LogLineSize) {
+    Length = LogLineSize - 1;
+    Line->Text[Length - 1] = '\n';
+  }
+  Line->Length = Length;
+  // hand the line to the consumer
+  Line->Sequence.store(LogRound(Position) + 1, std::memory_order_release);
+  if (LogTaskHandle != nullptr) {
+    xTaskNotifyGive(LogTaskHandle);
+  }
+}
+
+// Log - write all buffered lines to the serial interface, returns the number of lines
+int LogFlush() {
+  int Count = 0;
+  for (;;) {
+    LogLine& Line = LogRing[LogHead & (LogRingSize - 1)];
+    if (Line.Sequence.load(std::memory_order_acquire) != LogRound(LogHead) + 1) {
+      break;
+    }
+    Serial.write(reinterpret_cast<const uint8_t*>(Line.Text), Line.Length);
+    // free the line for the producer one round later
+    Line.Sequence.store(LogRound(LogHead) + LogRingSize, std::memory_order_release);
+    LogHead++;
+    Count++;
+  }
+  uint32_t Dropped = LogDropped.load(std::memory_order_relaxed) - LogDroppedReported;
+  if (Dropped > 0) {
+    LogDroppedReported += Dropped;
+    char Text[48];
+    int Length = snprintf(Text, sizeof(Text), "Log / %u lines dropped!\n", (unsigned)Dropped);
+    Serial.write(reinterpret_cast<const uint8_t*>(Text), Length);
+  }
+  return Count;
+}
+
+// Log - number of lines dropped since the start because the buffer was full
+uint32_t LogDroppedCount() {
+  return LogDropped.load(std::memory_order_relaxed);
+}
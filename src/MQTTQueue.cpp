@@ -0,0 +1,99 @@
+// -------------------------------------------------------------------
+// MQTT queue - outgoing messages kept while the session is down, sent in order afterwards
+// -------------------------------------------------------------------
+
+#include <MQTTQueue.h>
+#include <string.h>
+
+// record header, 'Size' includes header and padding
+struct MQTTQueueRecord {
+  uint16_t Size;
+  uint16_t Length;
+  uint8_t TopicLength;
+  uint8_t Flags;
+  uint16_t Reserved;
+};
+
+const uint8_t MQTTQueueRetained = 0x01;
+const uint8_t MQTTQueueSkip = 0x80;   // rest of the buffer unused, the next record starts at 0
+
+static_assert(sizeof(MQTTQueueRecord) == 8, "MQTT queue records are aligned to 8 bytes");
+static_assert(MQTTQueueBytes % 8 == 0 && MQTTQueueBytes <= 65536, "MQTT queue size");
+
+// MQTT queue - record header at 'Offset'
+static MQTTQueueRecord MQTTQueueHeader(const MQTTQueue& Queue, uint32_t Offset) {
+  MQTTQueueRecord Record;
+  memcpy(&Record, Queue.Buffer + Offset, sizeof(Record));
+  return Record;
+}
+
+// MQTT queue - append a message, drops the oldest ones until it fits, false if it can never fit
+bool MQTTQueuePush(MQTTQueue& Queue, const char* TopicName, const uint8_t* Payload, uint16_t Length, bool isRetained) {
+  size_t TopicLength = strlen(TopicName);
+  uint32_t Size = (sizeof(MQTTQueueRecord) + TopicLength + 1 + Length + 7) & ~7u;
+  // 'Tail' never reaches 'Head' while records are queued, so a full buffer is told apart from an empty one
+  if (TopicLength > 255 || Size >= MQTTQueueBytes) {
+    Queue.DroppedCount++;
+    return false;
+  }
+  for (;;) {
+    if (Queue.Count == 0) {
+      Queue.Head = 0;
+      Queue.Tail = 0;
+    }
+    if (Queue.Tail >= Queue.Head) {
+      if (MQTTQueueBytes - Queue.Tail >= Size) {
+        break;
+      }
+      if (Size < Queue.Head) {
+        // mark the unused end and continue at the start of the buffer
+        if (Queue.Tail < MQTTQueueBytes) {
+          MQTTQueueRecord Skip = { 0, 0, 0, MQTTQueueSkip, 0 };
+          memcpy(Queue.Buffer + Queue.Tail, &Skip, sizeof(Skip));
+        }
+        Queue.Tail = 0;
+        break;
+      }
+    }
+    else if (Size < Queue.Head - Queue.Tail) {
+      break;
+    }
+    MQTTQueuePop(Queue);
+    Queue.DroppedCount++;
+  }
+  MQTTQueueRecord Record = { (uint16_t)Size, Length, (uint8_t)TopicLength, (uint8_t)(isRetained ? MQTTQueueRetained : 0), 0 };
+  uint8_t* Data = Queue.Buffer + Queue.Tail;
+  memcpy(Data, &Record, sizeof(Record));
+  memcpy(Data + sizeof(Record), TopicName, TopicLength + 1);
+  memcpy(Data + sizeof(Record) + TopicLength + 1, Payload, Length);
+  Queue.Tail += Size;
+  Queue.Count++;
+  return true;
+}
+
+// MQTT queue - oldest message (pointers into the buffer, valid until the next push/pop), false if empty
+bool MQTTQueueFront(const MQTTQueue& Queue, const char*& TopicName, const uint8_t*& Payload, uint16_t& Length,
+                    bool& isRetained) {
+  if (Queue.Count == 0) {
+    return false;
+  }
+  MQTTQueueRecord Record = MQTTQueueHeader(Queue, Queue.Head);
+  TopicName = reinterpret_cast<const char*>(Queue.Buffer + Queue.Head + sizeof(Record));
+  Payload = Queue.Buffer + Queue.Head + sizeof(Record) + Record.TopicLength + 1;
+  Length = Record.Length;
+  isRetained = (Record.Flags & MQTTQueueRetained) != 0;
+  return true;
+}
+
+// MQTT queue - remove the oldest message
+void MQTTQueuePop(MQTTQueue& Queue) {
+  if (Queue.Count == 0) {
+    return;
+  }
+  Queue.Head += MQTTQueueHeader(Queue, Queue.Head).Size;
+  Queue.Count--;
+  // skip the unused end, 'Head' always points to a record while messages are queued
+  if (Queue.Count > 0 && (Queue.Head == MQTTQueueBytes || (MQTTQueueHeader(Queue, Queue.Head).Flags & MQTTQueueSkip))) {
+    Queue.Head = 0;
+  }
+}
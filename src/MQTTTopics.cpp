@@ -0,0 +1,231 @@
+// -------------------------------------------------------------------
+// MQTT topics - registry of all topics, dispatch and value parsing
+// -------------------------------------------------------------------
+
+#include <MQTTTopics.h>
+#include <ParseInteger.h>
+#include <stdio.h>
+#include <string.h>
+
+// MQTT topics - slot of a topic name, only length, first and last character are hashed
+static uint32_t MQTTTopicHash(const char* TopicName, size_t Length) {
+  if (Length == 0) {
+    return 0;
+  }
+  return (Length * 31 + (uint8_t)TopicName[0] * 7 + (uint8_t)TopicName[Length - 1]) & (MQTTTopicSlots - 1);
+}
+
+// MQTT topics - build the hash index of 'Count' topics, false if there are too many
+bool MQTTTopicIndexBuild(MQTTTopicIndex& Index, const MQTTTopic* Topics, int Count) {
+  memset(Index.Slot, -1, sizeof(Index.Slot));
+  Index.Topics = Topics;
+  Index.Count = 0;
+  if (Count * 2 > MQTTTopicSlots) {
+    return false;
+  }
+  for (int i = 0; i < Count; ++i) {
+    uint32_t Slot = MQTTTopicHash(Topics[i].Name, strlen(Topics[i].Name));
+    while (Index.Slot[Slot] >= 0) {
+      Slot = (Slot + 1) & (MQTTTopicSlots - 1);
+    }
+    Index.Slot[Slot] = i;
+  }
+  Index.Count = Count;
+  return true;
+}
+
+// MQTT topics - registry row of 'TopicName', nullptr if unknown
+const MQTTTopic* MQTTTopicFind(const MQTTTopicIndex& Index, const char* TopicName) {
+  return MQTTTopicFind(Index, TopicName, strlen(TopicName));
+}
+
+// MQTT topics - registry row of the first 'Length' characters of 'TopicName', nullptr if unknown
+const MQTTTopic* MQTTTopicFind(const MQTTTopicIndex& Index, const char* TopicName, size_t Length) {
+  uint32_t Slot = MQTTTopicHash(TopicName, Length);
+  // the index is at most half full, so probing always ends at a free slot
+  while (Index.Slot[Slot] >= 0) {
+    const MQTTTopic& Topic = Index.Topics[Index.Slot[Slot]];
+    if (strncmp(Topic.Name, TopicName, Length) == 0 && Topic.Name[Length] == '\0') {
+      return &Topic;
+    }
+    Slot = (Slot + 1) & (MQTTTopicSlots - 1);
+  }
+  return nullptr;
+}
+
+// MQTT topics - rest of 'TopicPath' behind "<Prefix>/", nullptr if the topic lies outside of 'Prefix'
+const char* MQTTTopicSuffix(const char* TopicPath, const char* Prefix) {
+  size_t Length = strlen(Prefix);
+  if (strncmp(TopicPath, Prefix, Length) != 0 || TopicPath[Length] != '/' || TopicPath[Length + 1] == '\0') {
+    return nullptr;
+  }
+  return TopicPath + Length + 1;
+}
+
+// MQTT topics - split an optional apply time "@<UnixMillis>|" off the front of a command message
+bool MQTTEnvelopeParse(const char* Message, unsigned int MessageLength, int64_t& ApplyAtMillis, unsigned int& Offset) {
+  ApplyAtMillis = 0;
+  Offset = 0;
+  if (MessageLength == 0 || Message[0] != '@') {
+    return true;
+  }
+  unsigned int i = 1;
+  int64_t Value = 0;
+  // at most 15 digits, far beyond any date and far from an overflow
+  while (i < MessageLength && i <= 15 && Message[i] >= '0' && Message[i] <= '9') {
+    Value = Value * 10 + (Message[i] - '0');
+    i++;
+  }
+  if (i == 1 || i >= MessageLength || Message[i] != '|' || Value == 0) {
+    return false;
+  }
+  ApplyAtMillis = Value;
+  Offset = i + 1;
+  return true;
+}
+
+// MQTT topics - number of integers of a topic value
+int MQTTTopicValueCount(MQTTTopicKind Kind) {
+  switch (Kind) {
+    case MQTTTopicTime:
+      return 2;
+    case MQTTTopicSetting:
+    case MQTTTopicScene:
+    case MQTTTopicPhase:
+      return 1;
+    case MQTTTopicColor:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+// MQTT topics - skip blanks and the characters of 'Skip' at position 'i'
+static void MQTTSkip(const char* Message, unsigned int MessageLength, unsigned int& i, const char* Skip) {
+  while (i < MessageLength && (Message[i] == ' ' || (Message[i] != '\0' && strchr(Skip, Message[i]) != nullptr))) {
+    i++;
+  }
+}
+
+// MQTT topics - parse and validate a message into 'Values', false on invalid input
+bool MQTTTopicParse(const MQTTTopic& Topic, const char* Message, unsigned int MessageLength, int* Values) {
+  int Count = MQTTTopicValueCount(Topic.Kind);
+  const char* Separator = Topic.Kind == MQTTTopicTime ? ":" : ",";
+  unsigned int i = 0;
+  MQTTSkip(Message, MessageLength, i, "[");
+  for (int k = 0; k < Count; ++k) {
+    if (k > 0) {
+      // exactly one separator between two integers
+      MQTTSkip(Message, MessageLength, i, "");
+      if (i >= MessageLength || Message[i] != Separator[0]) {
+        return false;
+      }
+      i++;
+      MQTTSkip(Message, MessageLength, i, "");
+    }
+    if (!ParseInteger(Message, MessageLength, i, 5, true, Values[k])) {
+      return false;
+    }
+  }
+  MQTTSkip(Message, MessageLength, i, "]");
+  if (i != MessageLength) {
+    return false;
+  }
+  // hours and minutes have a fixed range, all other values the range of the registry
+  if (Topic.Kind == MQTTTopicTime) {
+    return Values[0] >= 0 && Values[0] <= 23 && Values[1] >= 0 && Values[1] <= 59;
+  }
+  for (int k = 0; k < Count; ++k) {
+    if (Values[k] < Topic.Min || Values[k] > Topic.Max) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// MQTT topics - format 'Values' as message text, returns the text length
+int MQTTTopicFormat(const MQTTTopic& Topic, const int* Values, char* Buffer, size_t BufferSize) {
+  switch (Topic.Kind) {
+    case MQTTTopicTime:
+      return snprintf(Buffer, BufferSize, "%d:%02d", Values[0], Values[1]);
+    case MQTTTopicSetting:
+    case MQTTTopicScene:
+    case MQTTTopicPhase:
+      return snprintf(Buffer, BufferSize, "%d", Values[0]);
+    case MQTTTopicColor:
+      return snprintf(Buffer, BufferSize, "[%3d,%3d,%3d]", Values[0], Values[1], Values[2]);
+    default:
+      if (BufferSize > 0) {
+        Buffer[0] = '\0';
+      }
+      return 0;
+  }
+}
+
+// MQTT topics - append "Name=Value" (with ';' if 'Length' > 0) to the text in 'Buffer', returns the
+// new text length, a field that does not fit completely is left out
+size_t MQTTStateAppend(char* Buffer, size_t BufferSize, size_t Length, const MQTTTopic& Topic, const int* Values) {
+  char Value[24];
+  MQTTTopicFormat(Topic, Values, Value, sizeof(Value));
+  int Written = snprintf(Buffer + Length, BufferSize - Length, "%s%s=%s", Length > 0 ? ";" : "", Topic.Name, Value);
+  if (Written < 0 || Length + Written >= BufferSize) {
+    Buffer[Length] = '\0';
+    return Length;
+  }
+  return Length + Written;
+}
+
+// MQTT topics - parse and validate a configuration batch "Name=Value;Name=Value;..", a repeated
+// name replaces the earlier value, returns the number of fields or -1 if any field is invalid
+int MQTTConfigParse(const MQTTTopicIndex& Index, const char* Message, unsigned int MessageLength,
+                    MQTTConfigField* Fields, int MaxFields) {
+  int Count = 0;
+  unsigned int i = 0;
+  while (i < MessageLength) {
+    // one field up to the next separator, empty fields are skipped
+    unsigned int End = i;
+    while (End < MessageLength && Message[End] != ';' && Message[End] != '\n') {
+      End++;
+    }
+    unsigned int Start = i;
+    i = End + 1;
+    MQTTSkip(Message, End, Start, "\r");
+    if (Start == End) {
+      continue;
+    }
+    const char* Equals = static_cast<const char*>(memchr(Message + Start, '=', End - Start));
+    if (Equals == nullptr) {
+      return -1;
+    }
+    // name without trailing blanks
+    size_t NameLength = Equals - (Message + Start);
+    while (NameLength > 0 && Message[Start + NameLength - 1] == ' ') {
+      NameLength--;
+    }
+    const MQTTTopic* Topic = MQTTTopicFind(Index, Message + Start, NameLength);
+    if (Topic == nullptr || !(Topic->Flags & MQTTTopicSubscribe) || MQTTTopicValueCount(Topic->Kind) == 0) {
+      return -1;
+    }
+    // value without trailing blanks and carriage return
+    unsigned int ValueStart = Equals + 1 - Message;
+    unsigned int ValueEnd = End;
+    while (ValueEnd > ValueStart && (Message[ValueEnd - 1] == ' ' || Message[ValueEnd - 1] == '\r')) {
+      ValueEnd--;
+    }
+    int Field = 0;
+    while (Field < Count && Fields[Field].Topic != Topic) {
+      Field++;
+    }
+    if (Field == Count) {
+      if (Count == MaxFields) {
+        return -1;
+      }
+      Count++;
+    }
+    Fields[Field].Topic = Topic;
+    if (!MQTTTopicParse(*Topic, Message + ValueStart, ValueEnd - ValueStart, Fields[Field].Value)) {
+      return -1;
+    }
+  }
+  return Count;
+}
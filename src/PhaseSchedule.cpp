@@ -0,0 +1,318 @@
+// -------------------------------------------------------------------
+// Phase schedule - day/night phase with weekday and date rules, precomputed transitions
+// -------------------------------------------------------------------
+
+#include <ParseInteger.h>
+#include <PhaseSchedule.h>
+#include <stdio.h>
+#include <string.h>
+
+// Phase schedule - day phase at 'Minute' of the day (a night start before the day start wraps midnight)
+bool PhaseIsDay(int DayMinute, int NightMinute, int Minute) {
+  return (Minute >= DayMinute && Minute < NightMinute) ||
+         (Minute >= DayMinute && NightMinute < DayMinute) ||
+         (Minute < NightMinute && DayMinute > NightMinute);
+}
+
+// Phase schedule - a rule applies to the date of 'Local'
+static bool PhaseRuleMatches(const PhaseRule& Rule, const struct tm& Local) {
+  if (!(Rule.WeekdayMask & (1 << Local.tm_wday))) {
+    return false;
+  }
+  if (Rule.FirstDate == 0) {
+    return true;
+  }
+  // yearly ranges compare month and day only
+  uint32_t Date = (uint32_t)(Local.tm_mon + 1) * 100 + Local.tm_mday;
+  if (Rule.FirstDate > 10000) {
+    Date += (uint32_t)(Local.tm_year + 1900) * 10000;
+  }
+  if (Rule.FirstDate <= Rule.LastDate) {
+    return Date >= Rule.FirstDate && Date <= Rule.LastDate;
+  }
+  // yearly range across the turn of the year
+  return Date >= Rule.FirstDate || Date <= Rule.LastDate;
+}
+
+// Phase schedule - start times of the day 'Local' (date fields), the last matching rule wins
+void PhaseStartTimes(const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute, const struct tm& Local,
+                     int& DayMinute, int& NightMinute) {
+  DayMinute = DefaultDayMinute;
+  NightMinute = DefaultNightMinute;
+  for (int k = 0; k < Rules.Count; ++k) {
+    if (PhaseRuleMatches(Rules.Rule[k], Local)) {
+      DayMinute = Rules.Rule[k].DayMinute;
+      NightMinute = Rules.Rule[k].NightMinute;
+    }
+  }
+}
+
+// Phase schedule - wall-clock time of 'Minute' on the day 'DayOffset' days after the day of 'Local'
+// ('mktime()' takes care of the month end and DST, a skipped time moves forward)
+static time_t PhaseDayTime(const struct tm& Local, int DayOffset, int Minute) {
+  struct tm Time = Local;
+  Time.tm_mday += DayOffset;
+  Time.tm_hour = Minute / 60;
+  Time.tm_min = Minute % 60;
+  Time.tm_sec = 0;
+  Time.tm_isdst = -1;
+  return mktime(&Time);
+}
+
+// Phase schedule - phase at the wall-clock time 'Time'
+static bool PhaseIsDayAt(const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute, time_t Time) {
+  struct tm Local;
+  localtime_r(&Time, &Local);
+  int DayMinute;
+  int NightMinute;
+  PhaseStartTimes(Rules, DefaultDayMinute, DefaultNightMinute, Local, DayMinute, NightMinute);
+  return PhaseIsDay(DayMinute, NightMinute, Local.tm_hour * 60 + Local.tm_min);
+}
+
+// Phase schedule - append the transitions of the day starting at 'DayStart' (candidates: midnight,
+// day and night start; only real phase changes are kept)
+static void PhaseCompileDay(PhaseSchedule& Schedule, const PhaseRules& Rules, int DefaultDayMinute,
+                            int DefaultNightMinute, time_t DayStart) {
+  struct tm Day;
+  localtime_r(&DayStart, &Day);
+  int DayMinute;
+  int NightMinute;
+  PhaseStartTimes(Rules, DefaultDayMinute, DefaultNightMinute, Day, DayMinute, NightMinute);
+  time_t NextDayStart = PhaseDayTime(Day, 1, 0);
+  time_t Candidate[3] = {DayStart, PhaseDayTime(Day, 0, DayMinute), PhaseDayTime(Day, 0, NightMinute)};
+  if (Candidate[2] < Candidate[1]) {
+    time_t Swap = Candidate[1];
+    Candidate[1] = Candidate[2];
+    Candidate[2] = Swap;
+  }
+  for (int k = 0; k < 3; ++k) {
+    if (Candidate[k] < DayStart || Candidate[k] >= NextDayStart || (k > 0 && Candidate[k] == Candidate[k - 1])) {
+      continue;
+    }
+    struct tm Local;
+    localtime_r(&Candidate[k], &Local);
+    bool isDayPhase = PhaseIsDay(DayMinute, NightMinute, Local.tm_hour * 60 + Local.tm_min);
+    if (isDayPhase != Schedule.isDayPhaseAtEnd && Schedule.Count < PhaseMaxTransitions) {
+      Schedule.Transition[Schedule.Count].Time = Candidate[k];
+      Schedule.Transition[Schedule.Count].isDayPhase = isDayPhase;
+      Schedule.Count++;
+      Schedule.isDayPhaseAtEnd = isDayPhase;
+    }
+  }
+  Schedule.LastDayStart = DayStart;
+  Schedule.CompiledUntil = NextDayStart;
+  Schedule.CompiledDays++;
+}
+
+// Phase schedule - take the transitions reached at 'Now'
+static void PhaseScheduleTake(PhaseSchedule& Schedule, time_t Now) {
+  int Taken = 0;
+  while (Taken < Schedule.Count && Schedule.Transition[Taken].Time <= Now) {
+    Schedule.isDayPhase = Schedule.Transition[Taken].isDayPhase;
+    Taken++;
+  }
+  if (Taken > 0) {
+    Schedule.Count -= Taken;
+    memmove(Schedule.Transition, Schedule.Transition + Taken, sizeof(PhaseTransition) * Schedule.Count);
+  }
+}
+
+// Phase schedule - monotonic deadline: next transition or start of the last compiled day
+static void PhaseScheduleSetDeadline(PhaseSchedule& Schedule, time_t Now, int64_t Micros) {
+  time_t Next = Schedule.LastDayStart;
+  if (Schedule.Count > 0 && Schedule.Transition[0].Time < Next) {
+    Next = Schedule.Transition[0].Time;
+  }
+  Schedule.DeadlineMicros = Micros + (int64_t)(Next - Now) * 1000000;
+}
+
+// Phase schedule - compile the transitions of the current and the next day at the wall-clock time 'Now'
+void PhaseScheduleCompile(PhaseSchedule& Schedule, const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute,
+                          time_t Now, int64_t Micros) {
+  struct tm Local;
+  localtime_r(&Now, &Local);
+  time_t Today = PhaseDayTime(Local, 0, 0);
+  Schedule.Count = 0;
+  Schedule.isDayPhase = PhaseIsDayAt(Rules, DefaultDayMinute, DefaultNightMinute, Today - 1);
+  Schedule.isDayPhaseAtEnd = Schedule.isDayPhase;
+  PhaseCompileDay(Schedule, Rules, DefaultDayMinute, DefaultNightMinute, Today);
+  PhaseCompileDay(Schedule, Rules, DefaultDayMinute, DefaultNightMinute, Schedule.CompiledUntil);
+  PhaseScheduleTake(Schedule, Now);
+  PhaseScheduleSetDeadline(Schedule, Now, Micros);
+  Schedule.isValid = true;
+}
+
+// Phase schedule - take the transitions reached at 'Now', compile one more day after midnight and
+// set the next deadline, returns true if the phase changed
+bool PhaseScheduleAdvance(PhaseSchedule& Schedule, const PhaseRules& Rules, int DefaultDayMinute, int DefaultNightMinute,
+                          time_t Now, int64_t Micros) {
+  bool isDayPhase = Schedule.isDayPhase;
+  // without a list or after a jump beyond the compiled days everything is compiled again
+  if (!Schedule.isValid || Now >= Schedule.CompiledUntil) {
+    PhaseScheduleCompile(Schedule, Rules, DefaultDayMinute, DefaultNightMinute, Now, Micros);
+    return Schedule.isDayPhase != isDayPhase;
+  }
+  PhaseScheduleTake(Schedule, Now);
+  // midnight: the first compiled day is over, the list is extended by one day
+  if (Now >= Schedule.LastDayStart) {
+    PhaseCompileDay(Schedule, Rules, DefaultDayMinute, DefaultNightMinute, Schedule.CompiledUntil);
+  }
+  PhaseScheduleSetDeadline(Schedule, Now, Micros);
+  return Schedule.isDayPhase != isDayPhase;
+}
+
+// Phase schedule - read "MM-DD" or "YYYY-MM-DD" as YYYYMMDD (year 0) or '*' as 0
+static bool PhaseParseDate(const char* Message, unsigned int MessageLength, unsigned int& i, uint32_t& Date) {
+  if (i < MessageLength && Message[i] == '*') {
+    i++;
+    Date = 0;
+    return true;
+  }
+  int Field[3];
+  int Count = 0;
+  while (Count < 3) {
+    if (!ParseInteger(Message, MessageLength, i, Count == 0 ? 4 : 2, false, Field[Count])) {
+      return false;
+    }
+    Count++;
+    if (i >= MessageLength || Message[i] != '-') {
+      break;
+    }
+    i++;
+  }
+  if (Count < 2) {
+    return false;
+  }
+  int Year = Count == 3 ? Field[0] : 0;
+  int Month = Field[Count - 2];
+  int Day = Field[Count - 1];
+  if ((Count == 3 && Year < 2000) || Month < 1 || Month > 12 || Day < 1 || Day > 31) {
+    return false;
+  }
+  Date = (uint32_t)Year * 10000 + Month * 100 + Day;
+  return true;
+}
+
+// Phase schedule - read "H:MM" as minute of the day
+static bool PhaseParseTime(const char* Message, unsigned int MessageLength, unsigned int& i, uint16_t& Minute) {
+  int Hours;
+  int Minutes;
+  if (!ParseInteger(Message, MessageLength, i, 2, false, Hours) || i >= MessageLength || Message[i] != ':') {
+    return false;
+  }
+  i++;
+  if (!ParseInteger(Message, MessageLength, i, 2, false, Minutes) || Hours > 23 || Minutes > 59) {
+    return false;
+  }
+  Minute = Hours * 60 + Minutes;
+  return true;
+}
+
+// Phase schedule - parse "Days,From,To,H:MM,H:MM;.." (empty = no rules), false on invalid input
+bool PhaseRulesParse(const char* Message, unsigned int MessageLength, PhaseRules& Rules) {
+  PhaseRules Parsed;
+  unsigned int i = 0;
+  while (i < MessageLength) {
+    if (Parsed.Count == PhaseMaxRules) {
+      return false;
+    }
+    PhaseRule& Rule = Parsed.Rule[Parsed.Count];
+    memset(&Rule, 0, sizeof(PhaseRule));
+    // ISO weekdays (1 = Monday .. 7 = Sunday) or '*'
+    if (i < MessageLength && Message[i] == '*') {
+      Rule.WeekdayMask = 0x7F;
+      i++;
+    }
+    while (i < MessageLength && Message[i] >= '1' && Message[i] <= '7') {
+      Rule.WeekdayMask |= 1 << ((Message[i] - '0') % 7);
+      i++;
+    }
+    if (Rule.WeekdayMask == 0 || i >= MessageLength || Message[i] != ',') {
+      return false;
+    }
+    i++;
+    // date range, both yearly, both absolute or both '*'
+    if (!PhaseParseDate(Message, MessageLength, i, Rule.FirstDate) || i >= MessageLength || Message[i] != ',') {
+      return false;
+    }
+    i++;
+    if (!PhaseParseDate(Message, MessageLength, i, Rule.LastDate) ||
+        (Rule.FirstDate == 0) != (Rule.LastDate == 0) ||
+        (Rule.FirstDate > 10000) != (Rule.LastDate > 10000) ||
+        (Rule.FirstDate > 10000 && Rule.FirstDate > Rule.LastDate)) {
+      return false;
+    }
+    // start times of day and night
+    if (i >= MessageLength || Message[i] != ',') {
+      return false;
+    }
+    i++;
+    if (!PhaseParseTime(Message, MessageLength, i, Rule.DayMinute) || i >= MessageLength || Message[i] != ',') {
+      return false;
+    }
+    i++;
+    if (!PhaseParseTime(Message, MessageLength, i, Rule.NightMinute)) {
+      return false;
+    }
+    Parsed.Count++;
+    // rules are separated by ';'
+    if (i < MessageLength) {
+      if (Message[i] != ';') {
+        return false;
+      }
+      i++;
+    }
+  }
+  Rules = Parsed;
+  return true;
+}
+
+// Phase schedule - format a date of a rule
+static int PhaseFormatDate(uint32_t Date, char* Buffer, int BufferSize) {
+  if (Date == 0) {
+    return snprintf(Buffer, BufferSize, "*");
+  }
+  if (Date > 10000) {
+    return snprintf(Buffer, BufferSize, "%04u-%02u-%02u", (unsigned)(Date / 10000), (unsigned)(Date / 100 % 100),
+                    (unsigned)(Date % 100));
+  }
+  return snprintf(Buffer, BufferSize, "%02u-%02u", (unsigned)(Date / 100), (unsigned)(Date % 100));
+}
+
+// Phase schedule - format as 'Schedule' message, returns the length without terminator
+int PhaseRulesFormat(const PhaseRules& Rules, char* Buffer, int BufferSize) {
+  int Length = 0;
+  if (BufferSize > 0) {
+    Buffer[0] = '\0';
+  }
+  for (int k = 0; k < Rules.Count; ++k) {
+    const PhaseRule& Rule = Rules.Rule[k];
+    char Days[8];
+    int DayCount = 0;
+    if (Rule.WeekdayMask == 0x7F) {
+      Days[DayCount++] = '*';
+    }
+    else {
+      for (int Weekday = 1; Weekday <= 7; ++Weekday) {
+        if (Rule.WeekdayMask & (1 << (Weekday % 7))) {
+          Days[DayCount++] = '0' + Weekday;
+        }
+      }
+    }
+    Days[DayCount] = '\0';
+    char First[12];
+    char Last[12];
+    PhaseFormatDate(Rule.FirstDate, First, sizeof(First));
+    PhaseFormatDate(Rule.LastDate, Last, sizeof(Last));
+    int Written = snprintf(Buffer + Length, BufferSize - Length, "%s%s,%s,%s,%d:%02d,%d:%02d",
+                           k == 0 ? "" : ";", Days, First, Last, Rule.DayMinute / 60, Rule.DayMinute % 60,
+                           Rule.NightMinute / 60, Rule.NightMinute % 60);
+    if (Written < 0 || Written >= BufferSize - Length) {
+      // buffer too small, output truncated to complete rules
+      Buffer[Length] = '\0';
+      break;
+    }
+    Length += Written;
+  }
+  return Length;
+}
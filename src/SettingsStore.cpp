@@ -0,0 +1,216 @@
+// -------------------------------------------------------------------
+// Settings store - RAM cache of the NVS settings with debounced commits
+// -------------------------------------------------------------------
+
+#include <SettingsStore.h>
+#include <string.h>
+
+// Settings store - anything changed since the last commit
+static bool SettingsStoreIsDirty(const SettingsStore& Store) {
+  return Store.DirtyMask != 0 || Store.isTimelineDirty || Store.isRulesDirty;
+}
+
+// Settings store - remember the time of a change
+static void SettingsStoreTouch(SettingsStore& Store, uint32_t Now) {
+  if (!SettingsStoreIsDirty(Store)) {
+    Store.FirstChangeMillis = Now;
+  }
+  Store.LastChangeMillis = Now;
+}
+
+// Settings store - CRC-32 (IEEE 802.3), continued from 'Previous'
+uint32_t SettingsCRC32(const void* Data, size_t Length, uint32_t Previous) {
+  const uint8_t* Byte = static_cast<const uint8_t*>(Data);
+  uint32_t CRC = ~Previous;
+  while (Length-- > 0) {
+    CRC ^= *Byte++;
+    for (int k = 0; k < 8; ++k) {
+      CRC = (CRC >> 1) ^ (0xEDB88320 & (0 - (CRC & 1)));
+    }
+  }
+  return ~CRC;
+}
+
+// Settings store - offset of the values in a blob of 'Version' (version 1 has no phase rules)
+static size_t SettingsBlobValueOffset(uint8_t Version) {
+  return Version == 1 ? offsetof(SettingsBlob, Rules) : offsetof(SettingsBlob, Value);
+}
+
+// Settings store - size of a blob of 'Version' with 'ValueCount' values
+static size_t SettingsBlobSize(uint8_t Version, int ValueCount) {
+  return SettingsBlobValueOffset(Version) + sizeof(int32_t) * ValueCount;
+}
+
+// Settings store - take the settings of a stored blob, false if it is invalid
+static bool SettingsStoreReadBlob(SettingsStore& Store, const SettingsBlob& Blob, size_t StoredSize) {
+  if (StoredSize < offsetof(SettingsBlob, Rules) || (Blob.Version != SettingsBlobVersion && Blob.Version != 1) ||
+      Blob.ValueCount > SettingCount || StoredSize != SettingsBlobSize(Blob.Version, Blob.ValueCount) ||
+      Blob.CRC != SettingsCRC32(&Blob.Timeline, StoredSize - offsetof(SettingsBlob, Timeline)) ||
+      Blob.Timeline.Count > LightTimelineMaxKeyframes ||
+      (Blob.Version != 1 && Blob.Rules.Count > PhaseMaxRules)) {
+    return false;
+  }
+  Store.Timeline = Blob.Timeline;
+  if (Blob.Version == 1) {
+    // blob written before the phase rules existed, rewritten with the next commit
+    Store.Rules.Count = 0;
+    Store.isRulesDirty = true;
+  }
+  else {
+    Store.Rules = Blob.Rules;
+  }
+  const uint8_t* Values = reinterpret_cast<const uint8_t*>(&Blob) + SettingsBlobValueOffset(Blob.Version);
+  for (int i = 0; i < SettingCount; ++i) {
+    if (i < Blob.ValueCount) {
+      memcpy(&Store.Value[i], Values + sizeof(int32_t) * i, sizeof(int32_t));
+    }
+    else {
+      // setting added after the blob was written
+      Store.Value[i] = Store.Field[i].DefaultValue;
+      Store.DirtyMask |= 1UL << i;
+    }
+  }
+  return true;
+}
+
+// Settings store - import the legacy variables (one integer per setting and the timeline), false if none exist
+static bool SettingsStoreReadLegacy(SettingsStore& Store, Preferences& NVS) {
+  bool isFound = false;
+  for (int i = 0; i < SettingCount; ++i) {
+    int32_t SavedValue = NVS.getInt(Store.Field[i].VariableName, 999999);
+    if (SavedValue == 999999) {
+      Store.Value[i] = Store.Field[i].DefaultValue;
+    }
+    else {
+      Store.Value[i] = SavedValue;
+      isFound = true;
+    }
+  }
+  size_t StoredSize = NVS.getBytesLength(Store.TimelineVariableName);
+  if (StoredSize > 0 && StoredSize <= sizeof(LightTimeline)) {
+    NVS.getBytes(Store.TimelineVariableName, &Store.Timeline, StoredSize);
+    isFound = true;
+  }
+  // discard a damaged entry
+  if (Store.Timeline.Count > LightTimelineMaxKeyframes) {
+    Store.Timeline.Count = 0;
+  }
+  return isFound;
+}
+
+// Settings store - read the settings blob with one NVS read, otherwise import the legacy variables once
+SettingsSource SettingsStoreLoad(SettingsStore& Store, Preferences& NVS, const char* DBName, const char* BlobVariableName,
+                                 const SettingsField* Field, const char* TimelineVariableName) {
+  static SettingsBlob Blob;
+  SettingsSource Source = SettingsFromDefaults;
+  Store.DBName = DBName;
+  Store.BlobVariableName = BlobVariableName;
+  Store.Field = Field;
+  Store.TimelineVariableName = TimelineVariableName;
+  Store.DirtyMask = 0;
+  Store.isTimelineDirty = false;
+  Store.isRulesDirty = false;
+  Store.isLegacyImported = false;
+  Store.Timeline.Count = 0;
+  Store.Rules.Count = 0;
+  for (int i = 0; i < SettingCount; ++i) {
+    Store.Value[i] = Field[i].DefaultValue;
+  }
+  if (NVS.begin(DBName, true)) {
+    size_t StoredSize = NVS.getBytes(BlobVariableName, &Blob, sizeof(SettingsBlob));
+    if (StoredSize > 0 && SettingsStoreReadBlob(Store, Blob, StoredSize)) {
+      Source = SettingsFromBlob;
+    }
+    else {
+      Store.Timeline.Count = 0;
+      if (SettingsStoreReadLegacy(Store, NVS)) {
+        Source = SettingsFromLegacy;
+        Store.isLegacyImported = true;
+      }
+    }
+    NVS.end();
+  }
+  if (Source != SettingsFromBlob) {
+    // the blob is created with the next commit
+    Store.DirtyMask = (1UL << SettingCount) - 1;
+    Store.isTimelineDirty = true;
+    Store.isRulesDirty = true;
+  }
+  Store.FirstChangeMillis = 0;
+  Store.LastChangeMillis = 0;
+  return Source;
+}
+
+// Settings store - change a setting in RAM, returns false if the value is identical
+bool SettingsStoreSet(SettingsStore& Store, int Index, int32_t Value, uint32_t Now) {
+  if (Store.Value[Index] == Value) {
+    return false;
+  }
+  SettingsStoreTouch(Store, Now);
+  Store.Value[Index] = Value;
+  Store.DirtyMask |= 1UL << Index;
+  return true;
+}
+
+// Settings store - replace the light timeline in RAM
+void SettingsStoreSetTimeline(SettingsStore& Store, const LightTimeline& Timeline, uint32_t Now) {
+  SettingsStoreTouch(Store, Now);
+  Store.Timeline = Timeline;
+  Store.isTimelineDirty = true;
+}
+
+// Settings store - replace the phase rules in RAM
+void SettingsStoreSetRules(SettingsStore& Store, const PhaseRules& Rules, uint32_t Now) {
+  SettingsStoreTouch(Store, Now);
+  Store.Rules = Rules;
+  Store.isRulesDirty = true;
+}
+
+// Settings store - write the settings blob if anything changed
+void SettingsStoreCommit(SettingsStore& Store, Preferences& NVS) {
+  static SettingsBlob Blob;
+  if (!SettingsStoreIsDirty(Store)) {
+    return;
+  }
+  Blob.Version = SettingsBlobVersion;
+  Blob.ValueCount = SettingCount;
+  Blob.Reserved = 0;
+  Blob.Timeline = Store.Timeline;
+  // unused keyframes are stored as well, keep them empty
+  memset(&Blob.Timeline.Keyframe[Blob.Timeline.Count], 0,
+         sizeof(LightKeyframe) * (LightTimelineMaxKeyframes - Blob.Timeline.Count));
+  Blob.Rules = Store.Rules;
+  memset(&Blob.Rules.Rule[Blob.Rules.Count], 0, sizeof(PhaseRule) * (PhaseMaxRules - Blob.Rules.Count));
+  memcpy(Blob.Value, Store.Value, sizeof(Blob.Value));
+  Blob.CRC = SettingsCRC32(&Blob.Timeline, sizeof(SettingsBlob) - offsetof(SettingsBlob, Timeline));
+  // if 'DBName' does not exist, it will be automatically created now
+  NVS.begin(Store.DBName, false);
+  NVS.putBytes(Store.BlobVariableName, &Blob, sizeof(SettingsBlob));
+  Store.WriteCount++;
+  if (Store.isLegacyImported) {
+    // the legacy variables are imported only once
+    for (int i = 0; i < SettingCount; ++i) {
+      NVS.remove(Store.Field[i].VariableName);
+    }
+    NVS.remove(Store.TimelineVariableName);
+    Store.isLegacyImported = false;
+  }
+  NVS.end();
+  Store.DirtyMask = 0;
+  Store.isTimelineDirty = false;
+  Store.isRulesDirty = false;
+}
+
+// Settings store - commit once no change arrived for 'QuietMillis' (at the latest after 'MaxDelayMillis'),
+// returns true if committed
+bool SettingsStoreService(SettingsStore& Store, Preferences& NVS, uint32_t Now,
+                          uint32_t QuietMillis, uint32_t MaxDelayMillis) {
+  if (!SettingsStoreIsDirty(Store)) {
+    return false;
+  }
+  if (Now - Store.LastChangeMillis < QuietMillis && Now - Store.FirstChangeMillis < MaxDelayMillis) {
+    return false;
+  }
+  SettingsStoreCommit(Store, NVS);
+  return true;
+}
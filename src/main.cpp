@@ -4,16 +4,35 @@
 
 // standard
 #include <Arduino.h>
+#include <Log.h>
 // settings
 #include <SettingsGeneral.h>
 #include <SettingsWiFi.h>
 // additions
 #include <WiFi.h>
 #include <time.h>
+#include <sys/time.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <esp_sntp.h>
 #include <Preferences.h>
 #include <nvs_flash.h>
 #include <PubSubClient.h>
 #include <NeoPixelBus.h>
+// LED program
+#include <LEDGradient.h>
+#include <LEDTransition.h>
+#include <LEDDither.h>
+#include <SPSCQueue.h>
+// connections
+#include <ConnectionManager.h>
+#include <MQTTTopics.h>
+#include <MQTTQueue.h>
+#include <PhaseSchedule.h>
+// benchmarks ('-D BENCHMARK') and diagnostics ('-D DIAGNOSTICS=1')
+#include <Benchmark.h>
+#include <Diagnostics.h>
+#include <EventLoop.h>
 
 // -------------------------------------------------------------------
 // objects
@@ -21,12 +40,119 @@
 
 // NVS object
 Preferences preferences;
+// NVS cache, all settings in RAM, changes are committed debounced
+SettingsStore Settings;
 // WiFi object
 WiFiClient wifiClient;
 // MQTT object
 PubSubClient mqttClient(wifiClient);
-// LED Strip SK6812
-NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s1X8Sk6812Method> LEDStrip(LEDPixelCount, LEDPin);
+// MQTT topic dispatch (hash index over 'MQTTTopics')
+MQTTTopicIndex MQTTTopicTable;
+static_assert(MQTTTopicCount * 2 <= MQTTTopicSlots, "'MQTTTopics' needs at most half of 'MQTTTopicSlots'");
+// MQTT values published last per topic (timeline: checksum), only changes are published again
+enum MQTTPublishMode : uint8_t {
+  MQTTPublishChanged, // changed values only
+  MQTTPublishAll      // all values, e.g. on request
+};
+struct MQTTPublishedValue {
+  bool isValid;
+  int Value[MQTTTopicMaxValues];
+};
+MQTTPublishedValue MQTTPublished[MQTTTopicCount];
+// MQTT messages published while the session is down, sent in order once it is back
+MQTTQueue MQTTOutbox;
+// MQTT topic namespace of this device ('<prefix>/<Name>', commands on '<prefix>/set/<Name>') and client ID
+char MQTTDevicePrefix[48];
+char MQTTCommandPrefix[56];
+char MQTTClientID[48];
+// MQTT command prefixes of the groups of this device ('<root>/<group>/set')
+char MQTTGroupPrefix[MQTTGroupCount + 1][48]; // one spare, the group list may be empty
+// LED strips (one channel of the parallel I2S output each, created by the render task), bus type
+// and pixel color follow 'LEDStripColor'
+template <typename Color> struct LEDStripOutput;
+template <> struct LEDStripOutput<LEDColorGrbw> {
+  typedef NeoPixelBus<NeoGrbwFeature, NeoEsp32I2s1X8Sk6812Method> Bus;
+  static RgbwColor Pixel(const LEDPixelOutput& Pixel) { return RgbwColor(Pixel.R, Pixel.G, Pixel.B, Pixel.W); }
+};
+template <> struct LEDStripOutput<LEDColorGrb> {
+  typedef NeoPixelBus<NeoGrbFeature, NeoEsp32I2s1X8Ws2812xMethod> Bus;
+  static RgbColor Pixel(const LEDPixelOutput& Pixel) { return RgbColor(Pixel.R, Pixel.G, Pixel.B); }
+};
+typedef LEDStripOutput<LEDStripColor>::Bus LEDStripBus;
+static_assert(LEDStripCount >= 1 && LEDStripCount <= LEDStripMaxCount, "'LEDStrips' needs 1..8 strips");
+constexpr bool LEDStripsFitFrame(int Strip) {
+  return Strip >= LEDStripCount || (LEDStrips[Strip].PixelCount <= LEDCurveMaxPixels && LEDStripsFitFrame(Strip + 1));
+}
+static_assert(LEDStripsFitFrame(0), "a strip of 'LEDStrips' has more than 'LEDCurveMaxPixels' pixels");
+constexpr int LEDStripsPixelCount(int Strip) {
+  return Strip >= LEDStripCount ? 0 : LEDStrips[Strip].PixelCount + LEDStripsPixelCount(Strip + 1);
+}
+LEDStripBus* LEDStrip[LEDStripCount];
+// LED renderers specialized for the pixel count of each strip and 'LEDStripColor'
+struct LEDStripRenderer {
+  void (*Render)(LEDFrame& Frame, LEDCurveTable& Curve, const LEDGradientColors& Gradient);
+  void (*Clear)(LEDFrame& Frame);
+};
+template <typename List> struct LEDStripRendererTable;
+template <int... Strip> struct LEDStripRendererTable<LEDIndexList<Strip...>> {
+  static constexpr LEDStripRenderer Renderer[sizeof...(Strip)] = {
+    { &LEDRenderer<LEDStrips[Strip].PixelCount, LEDStripColor>::Render,
+      &LEDRenderer<LEDStrips[Strip].PixelCount, LEDStripColor>::Clear }...
+  };
+};
+template <int... Strip>
+constexpr LEDStripRenderer LEDStripRendererTable<LEDIndexList<Strip...>>::Renderer[sizeof...(Strip)];
+typedef LEDStripRendererTable<LEDIndexRange<LEDStripCount>::Type> LEDStripRenderers;
+// LED render command, posted by the network/config task ('loop()') to the render task
+enum LEDCommandType : uint8_t {
+  LEDCommandShow,     // render and show immediately
+  LEDCommandFade,     // cross-fade within 'TransitionMinutes'
+  LEDCommandTimeline  // render and show immediately, without pixel output
+};
+struct LEDCommand {
+  LEDCommandType Type;
+  int TransitionMinutes;
+  LightScene Scene;   // immutable settings snapshot
+  int64_t ApplyMicros; // apply time ('esp_timer_get_time()'), 0 = at once
+};
+SPSCQueue<LEDCommand, LEDCommandQueueSize> LEDCommandQueue;
+LEDCommand LEDCommandPending;
+bool LEDCommandIsPending = false;
+uint32_t LEDCommandLastPostMillis = 0;
+TaskHandle_t LEDRenderTaskHandle = nullptr;
+// apply time of the MQTT message being handled (0 = at once), taken over by 'LEDRequest()'
+int64_t LEDApplyMicros = 0;
+
+// --- objects below are owned by the render task ---
+// LED curve tables (Q16 fixed-point 'LEDAmplifierY' per pixel), one per strip
+LEDCurveTable LEDCurve[LEDStripCount];
+// LED frame buffers (retained RGBW pixels of the last render), one per strip
+LEDFrame LEDFrameBuffer[LEDStripCount];
+// LED day/night cross-fades and their target frames, one per strip (started and stepped together)
+LEDTransition LEDFade[LEDStripCount];
+LEDFrame LEDFrameTarget[LEDStripCount];
+// LED dither residuals, one per strip, and the refresh of frames with fractional channels
+LEDDitherState LEDDither[LEDStripCount];
+bool LEDDitherIsActive = false;
+uint32_t LEDDitherLastMillis = 0;
+uint32_t LEDDitherRefreshCount = 0; // refreshes of the shown frames
+// LED command waiting for its apply time, a 'Show' command is rendered on arrival into the staged frames
+LEDCommand LEDCommandStaged;
+bool LEDStageIsPending = false;
+LEDFrame LEDFrameStaged[LEDStripCount];
+// --- objects below are owned by the network/config task ---
+// LED scene of the light timeline shown last
+LightScene LEDTimelineScene;
+bool LEDTimelineSceneValid = false;
+unsigned long LEDTimelineLastMillis = 0;
+// time phase and the precomputed transitions of today and tomorrow (invalid after the time
+// settings or rules changed)
+PhaseSchedule TimePhaseSchedule;
+// one-shot timer at the next transition or midnight, its callback (timer task) only sets a flag
+esp_timer_handle_t NTPPhaseTimer = nullptr;
+std::atomic<bool> NTPPhaseTimerExpired{false};
+// set by the SNTP task after the system time was set, the transitions are compiled again
+std::atomic<bool> NTPTimeWasSet{false};
 
 // -------------------------------------------------------------------
 // forward declarations (allows functions in any order)
@@ -38,19 +164,60 @@ void WiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info);
 void WiFiStationDisconnected(WiFiEvent_t event, WiFiEventInfo_t info);
 void WiFiStartConnection();
 void WiFiActions();
-void MQTTStartConnection();
-void MQTTCallback(char* TopicName, byte* Message, unsigned int MessageLength);
-void MQTTSendSettings();
+void MQTTDeviceSetup();
+bool MQTTStartConnection();
+bool MQTTIsConnected();
+void MQTTTopicRead(const MQTTTopic& Topic, int* Values);
+void MQTTTopicWrite(const MQTTTopic& Topic, const int* Values, bool isDayPhase);
+void MQTTTopicApply(bool isTimeChanged, bool isSceneChanged);
+void MQTTReceiveConfig(const char* TopicName, const char* Message, unsigned int MessageLength);
+void MQTTReceiveTimeline(const char* TopicName, const char* Message, unsigned int MessageLength);
+void MQTTReceiveSchedule(const char* TopicName, const char* Message, unsigned int MessageLength);
+bool MQTTApplyTime(int64_t ApplyAtMillis, int64_t& ApplyMicros);
+void MQTTDispatch(const char* TopicName, byte* Message, unsigned int MessageLength);
+void MQTTCallback(char* TopicPath, byte* Message, unsigned int MessageLength);
+void MQTTSendSettings(MQTTPublishMode Mode);
+uint32_t MQTTTimelineCRC(const LightTimeline& Timeline);
+void MQTTPublish(const char* TopicName, const char* Message, bool isRetained);
+void MQTTSendQueued();
+void MQTTSendDiagnostics();
 void NTPGetServerTime();
-void NTPDateTime();
-float NTPTimeDecimal();
+bool NTPTimeIsSynced();
+void NTPDateTime(const char* Prefix);
+void NTPTimeSyncNotification(struct timeval* Time);
+void NTPPhaseTimerCallback(void* Argument);
 bool NTPCheckTimePhase();
-int NVSControlInteger(const char* DBName, const char* VariableName, bool WritingModeIsActive, int DefaultValue, int NewValue);
-float NVSControlFloat(const char* DBName, const char* VariableName, bool WritingModeIsActive, float DefaultValue, float NewValue);
 void NVSReadSettings(bool ReadTimeSettings, bool ReadTimePhaseSettings);
+void NVSWriteSceneValue(int Index, bool isDayPhase);
+void NVSLoadSettings();
+void NVSCommitService();
 void NVSFormat();
 void EmptySerialBuffer();
+uint32_t LoopWaitMillis();
+void LEDColorRender(int Strip, LEDFrame& Frame, const LightScene& Scene);
+bool LEDSwapFrames(const LEDFrame* Frames);
+bool LEDRenderFrames(const LightScene& Scene);
+void LEDStripShowFrames(const LEDFrame* Frames, bool isDithered = true);
+void LEDDitherService();
+void LEDColorControl(const LightScene& Scene);
+void LEDColorFade(const LightScene& Scene, int Minutes);
+void LEDTransitionService();
+void LEDCommandExecute(const LEDCommand& Command);
+void LEDStageCommand(const LEDCommand& Command);
+void LEDStageService();
+void LEDRenderTask(void* Parameter);
+LightScene LEDSceneCapture();
+void LEDRequest(LEDCommandType Type, const LightScene& Scene);
+void LEDRequestFlush();
 void LEDColorControl();
+void LEDColorFade();
+void LEDTimelineService();
+
+// connection state machine (WiFi, NTP, MQTT)
+Connection NetworkLink;
+const ConnectionHooks NetworkHooks = {
+  WiFiStartConnection, NTPGetServerTime, NTPTimeIsSynced, MQTTStartConnection, MQTTIsConnected, WiFiActions
+};
 
 // -------------------------------------------------------------------
 // functions
@@ -58,525 +225,500 @@ void LEDColorControl();
 
 // WiFi - events
 void WiFiStationConnected(WiFiEvent_t event, WiFiEventInfo_t info) {
-  Serial.printf("WiFi / '%s' successfully connected with '%s'!\n", WiFiHostname, WiFiSSID);
+  LOG_INFO("WiFi / '%s' successfully connected with '%s'!\n", WiFiHostname, WiFiSSID);
 }
 void WiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info) {
+  // without a valid IP address the connection manager retries after its timeout
   if (!(WiFi.localIP().toString() == "0.0.0.0")) {
-    Serial.print("WiFi / the IP address is: ");
-    Serial.println(WiFi.localIP());
+    LOG_INFO("WiFi / the IP address is: %s\n", WiFi.localIP().toString().c_str());
     digitalWrite(LED_BUILTIN, HIGH);
-    WiFiActions();
-  }
-  else {
-    WiFiStartConnection();
+    ConnectionNotifyWiFi(NetworkLink, true);
+    EventLoopSet(EventLoopWake);
   }
 }
 void WiFiStationDisconnected(WiFiEvent_t event, WiFiEventInfo_t info) {
-  if (!isConnecting) {
-    isConnecting = true;
-    WiFi.removeEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
-    Serial.println("WiFi / the connection was disconnected, start a new connection attempt...");
+  if (NetworkLink.isWiFiConnected) {
+    LOG_INFO("WiFi / the connection was disconnected, start a new connection attempt...\n");
     digitalWrite(LED_BUILTIN, LOW);
-    WiFiStartConnection();
+    ConnectionNotifyWiFi(NetworkLink, false);
+    EventLoopSet(EventLoopWake);
   }
 }
 
-// WiFi - initilize events (except 'WiFiStationDisconnected')
+// WiFi - initilize events
 void WiFiEventHandlersSetup() {
   WiFi.onEvent(WiFiStationConnected, WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_CONNECTED);
   WiFi.onEvent(WiFiGotIP, WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(WiFiStationDisconnected, WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
 }
 
-// WiFi - establish connection
+// WiFi - start connection establishment (the result arrives as event)
 void WiFiStartConnection() {
-  isConnecting = true;
-  Serial.printf("WiFi / connection establishment with '%s'...\n", WiFiSSID);
+  LOG_INFO("WiFi / connection establishment with '%s'...\n", WiFiSSID);
   WiFi.hostname(WiFiHostname);
   WiFi.begin(WiFiSSID, WiFiPassword);
-  delay(5000);
 }
 
-// WiFi - establish further connections + initilize event 'WiFiStationDisconnected'
+// WiFi - all connections established (again)
 void WiFiActions() {
-  delay(5000);
-  MQTTStartConnection();
-  NTPGetServerTime();
-  WiFi.onEvent(WiFiStationDisconnected, WiFiEvent_t::ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
-  OneTimeCodeExecutedDay = false;
-  OneTimeCodeExecutedNight = false;
-  isConnecting = false;
+  if (NetworkLink.isTimeSynced) {
+    NTPDateTime("Time / successfully synchronized: ");
+    LOG_INFO("-----\n");
+  }
+  // publish all values again, the shown frame stays (the time phase code only runs again once the
+  // phase changed, so a reconnect does not restart the cross-fade)
+  MQTTSendSettings(MQTTPublishAll);
+}
+
+// MQTT - topic namespace and client ID of this device (from 'WiFiHostname' and the MAC address)
+void MQTTDeviceSetup() {
+  uint8_t MAC[6];
+  WiFi.macAddress(MAC);
+  if (MQTTPrefixFromMAC) {
+    snprintf(MQTTDevicePrefix, sizeof(MQTTDevicePrefix), "%s-%02X%02X%02X", WiFiHostname, MAC[3], MAC[4], MAC[5]);
+  }
+  else {
+    snprintf(MQTTDevicePrefix, sizeof(MQTTDevicePrefix), "%s", WiFiHostname);
+  }
+  snprintf(MQTTCommandPrefix, sizeof(MQTTCommandPrefix), "%s/%s", MQTTDevicePrefix, MQTTCommandLevel);
+  for (int g = 0; g < MQTTGroupCount; ++g) {
+    snprintf(MQTTGroupPrefix[g], sizeof(MQTTGroupPrefix[g]), "%s/%s/%s", MQTTGroupRoot, MQTTGroups[g], MQTTCommandLevel);
+  }
+  snprintf(MQTTClientID, sizeof(MQTTClientID), "%s-%02X%02X%02X%02X%02X%02X", WiFiHostname, MAC[0], MAC[1], MAC[2],
+           MAC[3], MAC[4], MAC[5]);
+  LOG_INFO("MQTT / topic prefix '%s', client ID '%s'\n", MQTTDevicePrefix, MQTTClientID);
 }
 
-// MQTT - establish connection
-void MQTTStartConnection() {
+// MQTT - one connection attempt, returns true if connected
+bool MQTTStartConnection() {
   // Set MQTT broker
   mqttClient.setServer(MQTTServer, MQTTPort);
-  Serial.println("-----");
-  Serial.printf("MQTT / connection establishment with MQTT broker '%s'...\n", MQTTServer);
-  while (!mqttClient.connected()) {
-    delay(500);
-    if (mqttClient.connect("ESP32Client")) {
-      Serial.printf("MQTT / connected successfully with '%s'!\n", MQTTServer);
-      Serial.println("-----");
-      mqttClient.subscribe(MQTTTopicStartTimeDay);
-      mqttClient.subscribe(MQTTTopicStartTimeNight);
-      mqttClient.subscribe(MQTTTopicLEDStatus);
-      mqttClient.subscribe(MQTTTopicLEDBrightness);
-      mqttClient.subscribe(MQTTTopicLEDAmplifier);
-      mqttClient.subscribe(MQTTTopicLEDTauThousand);
-      mqttClient.subscribe(MQTTTopicLEDColorTop);
-      mqttClient.subscribe(MQTTTopicLEDColorBottom);
-      mqttClient.subscribe(MQTTTopicLEDColorWhite);
-      mqttClient.subscribe(MQTTTopicUpdate);
-      mqttClient.setCallback(MQTTCallback);
-    }
-    else
-    {
-      Serial.print("MQTT / connection failes, restart attempt...: ");
-      Serial.println(mqttClient.state());
+  mqttClient.setBufferSize(MQTTBufferSize);
+  mqttClient.setSocketTimeout(MQTTSocketTimeoutSeconds);
+  LOG_INFO("-----\n");
+  LOG_INFO("MQTT / connection establishment with MQTT broker '%s'...\n", MQTTServer);
+  if (mqttClient.connect(MQTTClientID)) {
+    LOG_INFO("MQTT / connected successfully with '%s'!\n", MQTTServer);
+    LOG_INFO("-----\n");
+    // one wildcard subscription for all commands of this device, 'MQTTCallback' dispatches on the name
+    char Subscription[64];
+    snprintf(Subscription, sizeof(Subscription), "%s/#", MQTTCommandPrefix);
+    mqttClient.subscribe(Subscription);
+    // and one per group, a single publish reaches all members
+    for (int g = 0; g < MQTTGroupCount; ++g) {
+      snprintf(Subscription, sizeof(Subscription), "%s/#", MQTTGroupPrefix[g]);
+      mqttClient.subscribe(Subscription);
     }
+    mqttClient.setCallback(MQTTCallback);
+    return true;
   }
+  LOG_WARN("MQTT / connection failes, restart attempt after backoff...: %d\n", mqttClient.state());
+  return false;
 }
 
-// MQTT - callback function for receiving a new MQTT Message
-void MQTTCallback(char* TopicName, byte* Message, unsigned int MessageLength) {
-  // check time phase
-  bool isDayPhase = NTPCheckTimePhase();
-  // -------------------------------------------------------------------
-  // topic is 'StartTimeDay'
-  // -------------------------------------------------------------------
-  if (strcmp(TopicName, MQTTTopicStartTimeDay) == 0) {
-    bool minutesStart = false;
-    int StartTimeDayHoursNew = 0;
-    int StartTimeDayMinutesNew = 0;
-    // read message and store values
-    for (int i=0;i<MessageLength;i++) {
-      if (Message[i] == ':') {
-        minutesStart = true;
-        i++; // skip this character
-      }
-      if (!minutesStart) {
-        StartTimeDayHoursNew = StartTimeDayHoursNew * 10 + ((char)Message[i] -'0');
-      }
-      else {
-        StartTimeDayMinutesNew = StartTimeDayMinutesNew * 10 + ((char)Message[i] -'0');
-      }
-    }
-    if (StartTimeDayHours != StartTimeDayHoursNew || StartTimeDayMinutes != StartTimeDayMinutesNew) {
-      StartTimeDayHours = StartTimeDayHoursNew;
-      StartTimeDayMinutes = StartTimeDayMinutesNew;
-      // build float for easier comparison with actual time
-      StartTimeDay = StartTimeDayHours + static_cast<float>(StartTimeDayMinutes) / 60.0;
-      Serial.printf("MQTT / message received on topic '%s': %.3f\n", TopicName, StartTimeDay);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database, but hours and minutes separately for higher precision
-      NVSControlInteger(NVSDBName, NVSVarStartTimeDayHours, true, NVSStdStartTimeDayHours, StartTimeDayHours);
-      NVSControlInteger(NVSDBName, NVSVarStartTimeDayMinutes, true, NVSStdStartTimeDayMinutes, StartTimeDayMinutes);
-      Serial.println("-----");
-    }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'StartTimeNight'
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicStartTimeNight) == 0) {
-    bool minutesStart = false;
-    int StartTimeNightHoursNew = 0;
-    int StartTimeNightMinutesNew = 0;
-    // read message and store values
-    for (int i=0;i<MessageLength;i++) {
-      if (Message[i] == ':') {
-        minutesStart = true;
-        i++; // skip this character
-      }
-      if (!minutesStart) {
-        StartTimeNightHoursNew = StartTimeNightHoursNew * 10 + ((char)Message[i] -'0');
-      }
-      else {
-        StartTimeNightMinutesNew = StartTimeNightMinutesNew * 10 + ((char)Message[i] -'0');
-      }
-    }
-    if (StartTimeNightHours != StartTimeNightHoursNew || StartTimeNightMinutes != StartTimeNightMinutesNew) {
-      StartTimeNightHours = StartTimeNightHoursNew;
-      StartTimeNightMinutes = StartTimeNightMinutesNew;
-      // build float for easier comparison with actual time
-      StartTimeNight = StartTimeNightHours + static_cast<float>(StartTimeNightMinutes) / 60.0;
-      Serial.printf("MQTT / message received on topic '%s': %.3f\n", TopicName, StartTimeNight);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database, but hours and minutes separately for higher precision
-      NVSControlInteger(NVSDBName, NVSVarStartTimeNightHours, true, NVSStdStartTimeNightHours, StartTimeNightHours);
-      NVSControlInteger(NVSDBName, NVSVarStartTimeNightMinutes, true, NVSStdStartTimeNightMinutes, StartTimeNightMinutes);
-      Serial.println("-----");
+// MQTT - query connection
+bool MQTTIsConnected() {
+  return mqttClient.connected();
+}
+
+// MQTT - current values of a topic
+void MQTTTopicRead(const MQTTTopic& Topic, int* Values) {
+  for (int k = 0; k < MQTTTopicValueCount(Topic.Kind); ++k) {
+    switch (Topic.Kind) {
+      case MQTTTopicTime:
+      case MQTTTopicSetting:
+        Values[k] = Settings.Value[Topic.Index + k];
+        break;
+      case MQTTTopicScene:
+      case MQTTTopicColor:
+        Values[k] = *LEDSceneValue[Topic.Index + k];
+        break;
+      case MQTTTopicPhase:
+        Values[k] = TimePhase;
+        break;
+      default:
+        break;
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDStatus', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDStatus) == 0) {
-    int LEDStatusNew = 0;
-    // read message and store value
-    for (int i=0;i<MessageLength;i++) {
-      LEDStatusNew = LEDStatusNew * 10 + ((char)Message[i] -'0');
-    }
-    if (LEDStatus != LEDStatusNew) {
-      LEDStatus = LEDStatusNew;
-      Serial.printf("MQTT / message received on topic '%s': %d\n", TopicName, LEDStatus);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDStatusDay, true, NVSStdLEDStatusDay, LEDStatus);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDStatusNight, true, NVSStdLEDStatusNight, LEDStatus);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+  }
+}
+
+// MQTT - store new values of a topic in the NVS cache (LED settings according to time phase),
+// the caller applies them once per message or batch
+void MQTTTopicWrite(const MQTTTopic& Topic, const int* Values, bool isDayPhase) {
+  for (int k = 0; k < MQTTTopicValueCount(Topic.Kind); ++k) {
+    if (Topic.Kind == MQTTTopicTime || Topic.Kind == MQTTTopicSetting) {
+      SettingsStoreSet(Settings, Topic.Index + k, Values[k], millis());
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDBrightness', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDBrightness) == 0) {
-    int LEDBrightnessNew = 0;
-    // read message and store value
-    for (int i=0;i<MessageLength;i++) {
-      LEDBrightnessNew = LEDBrightnessNew * 10 + ((char)Message[i] -'0');
-    }
-    if (LEDBrightness != LEDBrightnessNew) {
-      LEDBrightness = LEDBrightnessNew;
-      Serial.printf("MQTT / message received on topic '%s': %d\n", TopicName, LEDBrightness);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDBrightnessDay, true, NVSStdLEDBrightnessDay, LEDBrightness);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDBrightnessNight, true, NVSStdLEDBrightnessNight, LEDBrightness);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+    else if (Topic.Kind == MQTTTopicScene || Topic.Kind == MQTTTopicColor) {
+      *LEDSceneValue[Topic.Index + k] = Values[k];
+      NVSWriteSceneValue(Topic.Index + k, isDayPhase);
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDAmplifier', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDAmplifier) == 0) {
-    int LEDAmplifierNew = 0;
-    bool isNegative = false;
-    // check if first character is minus sign
-    if (Message[0] == '-') {
-      isNegative = true;
-    }
-    // start the loop at 0 or 1, depending on whether there is a minus sign
-    int startIndex = isNegative ? 1 : 0;
-    // read message and store value
-    for (int i=startIndex;i<MessageLength;i++) {
-      LEDAmplifierNew = LEDAmplifierNew * 10 + ((char)Message[i] -'0');
-    }
-    if (isNegative) {
-      LEDAmplifierNew = LEDAmplifierNew * -1;
-    }
-    if (LEDAmplifier != LEDAmplifierNew) {
-      LEDAmplifier = LEDAmplifierNew;
-      Serial.printf("MQTT / message received on topic '%s': %d\n", TopicName, LEDAmplifier);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDAmplifierDay, true, NVSStdLEDAmplifierDay, LEDAmplifier);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDAmplifierNight, true, NVSStdLEDAmplifierNight, LEDAmplifier);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+  }
+}
+
+// MQTT - apply stored values, timer settings and/or LED settings (one render), then publish the
+// changed values and the retained state
+void MQTTTopicApply(bool isTimeChanged, bool isSceneChanged) {
+  if (isTimeChanged) {
+    NVSReadSettings(true, false);
+  }
+  if (isSceneChanged) {
+    // build float (devide integer by 1000) for LED program
+    LEDTau = LEDTauThousand / 1000.0;
+    LEDColorControl();
+  }
+  MQTTSendSettings(MQTTPublishChanged);
+}
+
+// MQTT - receive a configuration batch, all fields are validated first and then applied together
+void MQTTReceiveConfig(const char* TopicName, const char* Message, unsigned int MessageLength) {
+  static MQTTConfigField Fields[MQTTConfigMaxFields];
+  int Count = MQTTConfigParse(MQTTTopicTable, Message, MessageLength, Fields, MQTTConfigMaxFields);
+  if (Count < 0) {
+    LOG_WARN("MQTT / invalid message on topic '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+    return;
+  }
+  // check time phase once for the whole batch
+  bool isDayPhase = NTPCheckTimePhase();
+  bool isTimeChanged = false;
+  bool isSceneChanged = false;
+  for (int i = 0; i < Count; ++i) {
+    const MQTTTopic& Topic = *Fields[i].Topic;
+    int Values[MQTTTopicMaxValues];
+    MQTTTopicRead(Topic, Values);
+    if (memcmp(Values, Fields[i].Value, sizeof(int) * MQTTTopicValueCount(Topic.Kind)) == 0) {
+      continue;
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDTauThousand', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDTauThousand) == 0) {
-    int LEDTauThousandNew = 0;
-    // read message and store value
-    for (int i=0;i<MessageLength;i++) {
-      LEDTauThousandNew = LEDTauThousandNew * 10.0 + ((char)Message[i] -'0');
-    }
-    if(LEDTauThousand != LEDTauThousandNew){
-      LEDTauThousand = LEDTauThousandNew;
-      // build float (devide integer by 1000) for LED program
-      LEDTau = LEDTauThousand / 1000.0;
-      Serial.printf("MQTT / message received on topic '%s': %.3f\n", TopicName, LEDTau);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDTauDay, true, NVSStdLEDTauDay, LEDTauThousand);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDTauNight, true, NVSStdLEDTauNight, LEDTauThousand);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+    MQTTTopicWrite(Topic, Fields[i].Value, isDayPhase);
+    if (Topic.Kind == MQTTTopicScene || Topic.Kind == MQTTTopicColor) {
+      isSceneChanged = true;
     }
     else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDColorTop', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDColorTop) == 0) {
-    int LEDColorTopRNew = 0;
-    int LEDColorTopGNew = 0;
-    int LEDColorTopBNew = 0;
-    // read message and store values
-    for (int i=1;i<=3;i++) {
-      if ((char)Message[i] != ' ') {
-        LEDColorTopRNew = LEDColorTopRNew * 10 + ((char)Message[i] -'0');
-      }
+      isTimeChanged = true;
     }
-    for (int i=5;i<=7;i++) {
-      if ((char)Message[i] != ' ') {
-        LEDColorTopGNew = LEDColorTopGNew * 10 + ((char)Message[i] -'0');
-      }
+  }
+  if (!isTimeChanged && !isSceneChanged) {
+    LOG_INFO("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+    return;
+  }
+  LOG_INFO("MQTT / message received on topic '%s': %d fields\n", TopicName, Count);
+  LOG_INFO("-----\n");
+  MQTTTopicApply(isTimeChanged, isSceneChanged);
+  LOG_INFO("-----\n");
+}
+
+// MQTT - receive a new light timeline
+void MQTTReceiveTimeline(const char* TopicName, const char* Message, unsigned int MessageLength) {
+  LightTimeline TimelineNew;
+  // read message and store keyframes
+  if (!LightTimelineParse(Message, MessageLength, TimelineNew)) {
+    LOG_WARN("MQTT / invalid message on topic '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+  }
+  else if (TimelineNew.Count != Settings.Timeline.Count ||
+           memcmp(TimelineNew.Keyframe, Settings.Timeline.Keyframe, sizeof(LightKeyframe) * TimelineNew.Count) != 0) {
+    LOG_INFO("MQTT / message received on topic '%s': %d keyframes\n", TopicName, TimelineNew.Count);
+    LOG_INFO("-----\n");
+    // store 'NewValue' in NVS cache
+    SettingsStoreSetTimeline(Settings, TimelineNew, millis());
+    // render the new timeline immediately or return to the day/night settings
+    LEDTimelineLastMillis = 0;
+    LEDTimelineSceneValid = false;
+    OneTimeCodeExecutedDay = false;
+    OneTimeCodeExecutedNight = false;
+    MQTTSendSettings(MQTTPublishChanged);
+  }
+  else {
+    LOG_INFO("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+  }
+}
+
+// MQTT - receive new weekday/date rules of the time phase
+void MQTTReceiveSchedule(const char* TopicName, const char* Message, unsigned int MessageLength) {
+  PhaseRules RulesNew;
+  if (!PhaseRulesParse(Message, MessageLength, RulesNew)) {
+    LOG_WARN("MQTT / invalid message on topic '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+  }
+  else if (RulesNew.Count != Settings.Rules.Count ||
+           memcmp(RulesNew.Rule, Settings.Rules.Rule, sizeof(PhaseRule) * RulesNew.Count) != 0) {
+    LOG_INFO("MQTT / message received on topic '%s': %d rules\n", TopicName, RulesNew.Count);
+    LOG_INFO("-----\n");
+    // store in NVS cache, the transitions are compiled again with the next phase check
+    SettingsStoreSetRules(Settings, RulesNew, millis());
+    PhaseScheduleInvalidate(TimePhaseSchedule);
+    MQTTSendSettings(MQTTPublishChanged);
+  }
+  else {
+    LOG_INFO("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+  }
+}
+
+// MQTT - callback function for receiving a new MQTT Message
+void MQTTCallback(char* TopicPath, byte* Message, unsigned int MessageLength) {
+  // commands arrive on '<prefix>/set/<Name>' or '<root>/<group>/set/<Name>', the registry is searched
+  // for the name
+  const char* TopicName = MQTTTopicSuffix(TopicPath, MQTTCommandPrefix);
+  for (int g = 0; TopicName == nullptr && g < MQTTGroupCount; ++g) {
+    TopicName = MQTTTopicSuffix(TopicPath, MQTTGroupPrefix[g]);
+  }
+  if (TopicName == nullptr) {
+    return;
+  }
+  // an apply time in front of the message is taken over by the render command of the message
+  int64_t ApplyAtMillis;
+  unsigned int Offset;
+  if (!MQTTEnvelopeParse((const char*)Message, MessageLength, ApplyAtMillis, Offset) ||
+      !MQTTApplyTime(ApplyAtMillis, LEDApplyMicros)) {
+    LOG_WARN("MQTT / invalid apply time on topic '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+    return;
+  }
+  MQTTDispatch(TopicName, Message + Offset, MessageLength - Offset);
+  LEDApplyMicros = 0;
+}
+
+// MQTT - monotonic time ('esp_timer_get_time()') of an apply time (Unix milliseconds), 0 = at once
+// (none, already reached or no system time), false if it lies too far ahead
+bool MQTTApplyTime(int64_t ApplyAtMillis, int64_t& ApplyMicros) {
+  ApplyMicros = 0;
+  if (ApplyAtMillis == 0) {
+    return true;
+  }
+  if (!NetworkLink.isTimeSynced) {
+    LOG_WARN("MQTT / apply time without synchronized system time, applied at once!\n");
+    return true;
+  }
+  struct timeval Now;
+  gettimeofday(&Now, nullptr);
+  int64_t Delay = ApplyAtMillis * 1000 - ((int64_t)Now.tv_sec * 1000000 + Now.tv_usec);
+  if (Delay > (int64_t)MQTTApplyMaxMillis * 1000) {
+    return false;
+  }
+  if (Delay > 0) {
+    ApplyMicros = esp_timer_get_time() + Delay;
+  }
+  return true;
+}
+
+// MQTT - execute a received message of the registry topic 'TopicName'
+void MQTTDispatch(const char* TopicName, byte* Message, unsigned int MessageLength) {
+  const MQTTTopic* Topic = MQTTTopicFind(MQTTTopicTable, TopicName);
+  if (Topic == nullptr || !(Topic->Flags & MQTTTopicSubscribe)) {
+    return;
+  }
+  if (Topic->Kind == MQTTTopicCommand) {
+    if (Topic->Index == MQTTCommandUpdate) {
+      LOG_INFO("MQTT / message received on topic '%s'\n", TopicName);
+      LOG_INFO("MQTT / start sending settings...\n");
+      LOG_INFO("-----\n");
+      MQTTSendSettings(MQTTPublishAll);
     }
-    for (int i=9;i<=11;i++) {
-      if ((char)Message[i] != ' ') {
-        LEDColorTopBNew = LEDColorTopBNew * 10 + ((char)Message[i] -'0');
-      }
+    return;
+  }
+  if (Topic->Kind == MQTTTopicTimeline) {
+    MQTTReceiveTimeline(TopicName, (const char*)Message, MessageLength);
+    return;
+  }
+  if (Topic->Kind == MQTTTopicSchedule) {
+    MQTTReceiveSchedule(TopicName, (const char*)Message, MessageLength);
+    return;
+  }
+  if (Topic->Kind == MQTTTopicConfig) {
+    MQTTReceiveConfig(TopicName, (const char*)Message, MessageLength);
+    return;
+  }
+  int ValuesNew[MQTTTopicMaxValues];
+  int Values[MQTTTopicMaxValues];
+  // read message and validate values
+  if (!MQTTTopicParse(*Topic, (const char*)Message, MessageLength, ValuesNew)) {
+    LOG_WARN("MQTT / invalid message on topic '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+    return;
+  }
+  MQTTTopicRead(*Topic, Values);
+  if (memcmp(Values, ValuesNew, sizeof(int) * MQTTTopicValueCount(Topic->Kind)) == 0) {
+    LOG_INFO("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
+    LOG_INFO("-----\n");
+    return;
+  }
+  char Text[24];
+  MQTTTopicFormat(*Topic, ValuesNew, Text, sizeof(Text));
+  LOG_INFO("MQTT / message received on topic '%s': %s\n", TopicName, Text);
+  LOG_INFO("-----\n");
+  // store 'NewValue' in NVS cache (LED settings according to time phase) and apply it
+  bool isSceneTopic = Topic->Kind == MQTTTopicScene || Topic->Kind == MQTTTopicColor;
+  MQTTTopicWrite(*Topic, ValuesNew, isSceneTopic && NTPCheckTimePhase());
+  MQTTTopicApply(!isSceneTopic, isSceneTopic);
+  LOG_INFO("-----\n");
+}
+
+// MQTT - checksum of the keyframes of a timeline, over the fields only (the padding of
+// 'LightTimeline' is not part of it)
+uint32_t MQTTTimelineCRC(const LightTimeline& Timeline) {
+  uint32_t CRC = SettingsCRC32(&Timeline.Count, sizeof(Timeline.Count));
+  for (int k = 0; k < Timeline.Count; ++k) {
+    const LightKeyframe& Keyframe = Timeline.Keyframe[k];
+    CRC = SettingsCRC32(&Keyframe.Minute, sizeof(Keyframe.Minute), CRC);
+    CRC = SettingsCRC32(Keyframe.Scene.Value, sizeof(Keyframe.Scene.Value), CRC);
+  }
+  return CRC;
+}
+
+// MQTT - publish the settings (all or changed values only) and the retained state snapshot
+void MQTTSendSettings(MQTTPublishMode Mode) {
+  static char Message[MQTTBufferSize];
+  static char State[MQTTBufferSize];
+  size_t StateLength = 0;
+  bool isChanged = false;
+  const MQTTTopic* StateTopic = nullptr;
+  for (int i = 0; i < MQTTTopicCount; ++i) {
+    const MQTTTopic& Topic = MQTTTopics[i];
+    if (!(Topic.Flags & MQTTTopicPublish)) {
+      continue;
     }
-    if (LEDColorTopR != LEDColorTopRNew || LEDColorTopG != LEDColorTopGNew || LEDColorTopB != LEDColorTopBNew) {
-      LEDColorTopR = LEDColorTopRNew;
-      LEDColorTopG = LEDColorTopGNew;
-      LEDColorTopB = LEDColorTopBNew;
-      Serial.printf("MQTT / message received on topic '%s': %d, %d, %d\n", TopicName, LEDColorTopR, LEDColorTopG, LEDColorTopB);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayR, true, NVSStdLEDColorTopDayR, LEDColorTopR);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayG, true, NVSStdLEDColorTopDayG, LEDColorTopG);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayB, true, NVSStdLEDColorTopDayB, LEDColorTopB);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightR, true, NVSStdLEDColorTopNightR, LEDColorTopR);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightG, true, NVSStdLEDColorTopNightG, LEDColorTopG);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightB, true, NVSStdLEDColorTopNightB, LEDColorTopB);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+    if (Topic.Kind == MQTTTopicState) {
+      StateTopic = &Topic;
+      continue;
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDColorBottom', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDColorBottom) == 0) {
-    int LEDColorBottomRNew = 0;
-    int LEDColorBottomGNew = 0;
-    int LEDColorBottomBNew = 0;
-    // read message and store values
-    for (int i=1;i<=3;i++) {
-      if ((char)Message[i] != ' ') {
-      LEDColorBottomRNew = LEDColorBottomRNew * 10 + ((char)Message[i] -'0');
+    bool isPublished = MQTTPublished[i].isValid && Mode == MQTTPublishChanged;
+    if (Topic.Kind == MQTTTopicTimeline) {
+      // the timeline is compared by its checksum and published on its own topic only
+      uint32_t TimelineCRC = MQTTTimelineCRC(Settings.Timeline);
+      if ((isPublished && MQTTPublished[i].Value[0] == (int)TimelineCRC) || !MQTTPublishTopicMessages) {
+        continue;
       }
+      LightTimelineFormat(Settings.Timeline, Message, sizeof(Message));
+      MQTTPublish(Topic.Name, Message, false);
+      MQTTPublished[i].Value[0] = (int)TimelineCRC;
+      MQTTPublished[i].isValid = true;
+      continue;
     }
-    for (int i=5;i<=7;i++) {
-      if ((char)Message[i] != ' ') {
-      LEDColorBottomGNew = LEDColorBottomGNew * 10 + ((char)Message[i] -'0');
+    if (Topic.Kind == MQTTTopicSchedule) {
+      // the rules as well
+      uint32_t RulesCRC = SettingsCRC32(Settings.Rules.Rule, sizeof(PhaseRule) * Settings.Rules.Count);
+      if ((isPublished && MQTTPublished[i].Value[0] == (int)RulesCRC) || !MQTTPublishTopicMessages) {
+        continue;
       }
+      PhaseRulesFormat(Settings.Rules, Message, sizeof(Message));
+      MQTTPublish(Topic.Name, Message, false);
+      MQTTPublished[i].Value[0] = (int)RulesCRC;
+      MQTTPublished[i].isValid = true;
+      continue;
     }
-    for (int i=9;i<=11;i++) {
-      if ((char)Message[i] != ' ') {
-      LEDColorBottomBNew = LEDColorBottomBNew * 10 + ((char)Message[i] -'0');
-      }
+    int Values[MQTTTopicMaxValues];
+    MQTTTopicRead(Topic, Values);
+    if (isPublished && memcmp(MQTTPublished[i].Value, Values, sizeof(int) * MQTTTopicValueCount(Topic.Kind)) == 0) {
+      continue;
     }
-    if (LEDColorBottomR != LEDColorBottomRNew || LEDColorBottomG != LEDColorBottomGNew || LEDColorBottomB != LEDColorBottomBNew) {
-      LEDColorBottomR = LEDColorBottomRNew;
-      LEDColorBottomG = LEDColorBottomGNew;
-      LEDColorBottomB = LEDColorBottomBNew;
-      Serial.printf("MQTT / message received on topic '%s': %d, %d, %d\n", TopicName, LEDColorBottomR, LEDColorBottomG, LEDColorBottomB);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayR, true, NVSStdLEDColorBottomDayR, LEDColorBottomR);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayG, true, NVSStdLEDColorBottomDayG, LEDColorBottomG);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayB, true, NVSStdLEDColorBottomDayB, LEDColorBottomB);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightR, true, NVSStdLEDColorBottomNightR, LEDColorBottomR);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightG, true, NVSStdLEDColorBottomNightG, LEDColorBottomG);
-        NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightB, true, NVSStdLEDColorBottomNightB, LEDColorBottomB);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+    isChanged = true;
+    if (MQTTPublishTopicMessages) {
+      MQTTTopicFormat(Topic, Values, Message, sizeof(Message));
+      MQTTPublish(Topic.Name, Message, false);
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
-    }
-  }
-  // -------------------------------------------------------------------
-  // topic is 'LEDColorWhite', day and night
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicLEDColorWhite) == 0) {
-    int LEDColorWhiteNew = 0;
-    // read message and store value
-    for (int i=0;i<MessageLength;i++) {
-      LEDColorWhiteNew = LEDColorWhiteNew * 10 + ((char)Message[i] -'0');
-    }
-    if (LEDColorWhite != LEDColorWhiteNew) {
-      LEDColorWhite = LEDColorWhiteNew;
-      Serial.printf("MQTT / message received on topic '%s': %d\n", TopicName, LEDColorWhite);
-      Serial.println("-----");
-      // store 'NewValue' in NVS database according to time phase
-      if (isDayPhase) {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorWhiteDay, true, NVSStdLEDColorWhiteDay, LEDColorWhite);
-      }
-      else {
-        NVSControlInteger(NVSDBName, NVSVarLEDColorWhiteNight, true, NVSStdLEDColorWhiteNight, LEDColorWhite);
-      }
-      Serial.println("-----");
-      LEDColorControl();
+    memcpy(MQTTPublished[i].Value, Values, sizeof(Values));
+    MQTTPublished[i].isValid = true;
+  }
+  // one retained message, the broker hands the latest state to every new subscriber; it is only
+  // formatted when published, from the values just stored in 'MQTTPublished'
+  if (StateTopic == nullptr || (!isChanged && Mode != MQTTPublishAll)) {
+    return;
+  }
+  State[0] = '\0';
+  for (int i = 0; i < MQTTTopicCount; ++i) {
+    const MQTTTopic& Topic = MQTTTopics[i];
+    if (Topic.Kind == MQTTTopicState || Topic.Kind == MQTTTopicTimeline || Topic.Kind == MQTTTopicSchedule ||
+        !MQTTPublished[i].isValid) {
+      continue;
     }
-    else {
-      Serial.printf("MQTT / identical incoming message for '%s' ignored!\n", TopicName);
-      Serial.println("-----");
+    StateLength = MQTTStateAppend(State, sizeof(State), StateLength, Topic, MQTTPublished[i].Value);
+  }
+  MQTTPublish(StateTopic->Name, State, true);
+}
+
+// MQTT - publish a message to '<prefix>/<TopicName>', while the session is down (or older messages
+// still wait) it is queued
+void MQTTPublish(const char* TopicName, const char* Message, bool isRetained) {
+  char TopicPath[96];
+  snprintf(TopicPath, sizeof(TopicPath), "%s/%s", MQTTDevicePrefix, TopicName);
+  if (MQTTOutbox.Count == 0 && mqttClient.connected()) {
+    // a message too large for the client buffer is dropped, queuing would not help
+    if (mqttClient.publish(TopicPath, Message, isRetained) || mqttClient.connected()) {
+      return;
     }
   }
-  // -------------------------------------------------------------------
-  // topic is 'Update'
-  // -------------------------------------------------------------------
-  else if (strcmp(TopicName, MQTTTopicUpdate) == 0) {
-    Serial.printf("MQTT / message received on topic '%s'\n", TopicName);
-    Serial.println("MQTT / start sending settings...");
-    Serial.println("-----");
-    MQTTSendSettings();
+  MQTTQueuePush(MQTTOutbox, TopicPath, reinterpret_cast<const uint8_t*>(Message), strlen(Message), isRetained);
+}
+
+// MQTT - send the queued messages in order once the session is back
+void MQTTSendQueued() {
+  if (MQTTOutbox.Count == 0 || NetworkLink.State != ConnectionOnline || !mqttClient.connected()) {
+    return;
+  }
+  int Sent = 0;
+  const char* TopicName;
+  const uint8_t* Payload;
+  uint16_t Length;
+  bool isRetained;
+  while (MQTTQueueFront(MQTTOutbox, TopicName, Payload, Length, isRetained)) {
+    if (!mqttClient.publish(TopicName, Payload, Length, isRetained) && !mqttClient.connected()) {
+      // lost again, the rest waits for the next session
+      break;
+    }
+    MQTTQueuePop(MQTTOutbox);
+    Sent++;
   }
+  LOG_INFO("MQTT / %d queued messages sent, %u dropped since start (queue full)\n", Sent,
+           (unsigned)MQTTOutbox.DroppedCount);
+  LOG_INFO("-----\n");
 }
 
-// MQTT - send new setting on time phase shift
-void MQTTSendSettings() {
-  std::string message;
-  std::string PaddingR;
-  std::string PaddingG;
-  std::string PaddingB;
+// MQTT - publish the diagnostics counters every 'DiagnosticsIntervalMillis' (empty without '-D DIAGNOSTICS=1')
+void MQTTSendDiagnostics() {
+#if DIAGNOSTICS
+  static char Topic[64];
+  static char Message[448];
+  static uint32_t LastMillis = 0;
+  uint32_t Now = millis();
+  if (Now - LastMillis < DiagnosticsIntervalMillis) {
+    return;
+  }
+  LastMillis = Now;
+  // the interval counters restart even without connection, a report always covers one interval
+  int Length = DiagnosticsFormat(Message, sizeof(Message), Now, Settings.WriteCount, NetworkLink.ReconnectCount);
+  if (Length < 0 || !mqttClient.connected()) {
+    return;
+  }
+  if (Topic[0] == '\0') {
+    snprintf(Topic, sizeof(Topic), "%s/%s", MQTTDevicePrefix, DiagnosticsTopicName);
+  }
+  mqttClient.publish(Topic, Message);
+#endif
+}
 
-  auto resetVariables = [&]() {
-    message = "";
-    PaddingR = "";
-    PaddingG = "";
-    PaddingB = "";
-  };
-  
-  // StartTimeDay
-  message = std::to_string(StartTimeDayHours) + ":" + (StartTimeDayMinutes < 10 ? "0" : "") + std::to_string(StartTimeDayMinutes);
-  mqttClient.publish(MQTTTopicStartTimeDay, message.c_str());
-  resetVariables();
-
-  // StartTimeNight
-  message = std::to_string(StartTimeNightHours) + ":" + (StartTimeNightMinutes < 10 ? "0" : "") + std::to_string(StartTimeNightMinutes);
-  mqttClient.publish(MQTTTopicStartTimeNight, message.c_str());
-  resetVariables();
-
-  // TimePhase
-  message = std::to_string(TimePhase);
-  mqttClient.publish(MQTTTopicTimePhase, message.c_str());
-  resetVariables();
-
-  // LEDStatus
-  message = std::to_string(LEDStatus);
-  mqttClient.publish(MQTTTopicLEDStatus, message.c_str());
-  resetVariables();
-
-  // LEDBrightness
-  message = std::to_string(LEDBrightness);
-  mqttClient.publish(MQTTTopicLEDBrightness, message.c_str());
-  resetVariables();
-
-  // LEDAmplifier
-  message = std::to_string(LEDAmplifier);
-  mqttClient.publish(MQTTTopicLEDAmplifier, message.c_str());
-  resetVariables();
-
-  // LEDTau
-  message = std::to_string(LEDTauThousand);
-  mqttClient.publish(MQTTTopicLEDTauThousand, message.c_str());
-  resetVariables();
-
-  // LEDColorTop
-  PaddingR = (LEDColorTopR < 10 ? "  " : (LEDColorTopR < 100 ? " " : ""));
-  PaddingG = (LEDColorTopG < 10 ? "  " : (LEDColorTopG < 100 ? " " : ""));
-  PaddingB = (LEDColorTopB < 10 ? "  " : (LEDColorTopB < 100 ? " " : ""));
-  message = "[" +
-            PaddingR + std::to_string(LEDColorTopR) + "," +
-            PaddingG + std::to_string(LEDColorTopG) + "," +
-            PaddingB + std::to_string(LEDColorTopB) + "]";
-  mqttClient.publish(MQTTTopicLEDColorTop, message.c_str());
-  resetVariables();
-
-  // LEDColorBottom
-  PaddingR = (LEDColorBottomR < 10 ? "  " : (LEDColorBottomR < 100 ? " " : ""));
-  PaddingG = (LEDColorBottomG < 10 ? "  " : (LEDColorBottomG < 100 ? " " : ""));
-  PaddingB = (LEDColorBottomB < 10 ? "  " : (LEDColorBottomB < 100 ? " " : ""));
-  message = "[" +
-            PaddingR + std::to_string(LEDColorBottomR) + "," +
-            PaddingG + std::to_string(LEDColorBottomG) + "," +
-            PaddingB + std::to_string(LEDColorBottomB) + "]";
-  mqttClient.publish(MQTTTopicLEDColorBottom, message.c_str());
-  resetVariables();
-
-  // LEDColorWhite
-  message = std::to_string(LEDColorWhite);
-  mqttClient.publish(MQTTTopicLEDColorWhite, message.c_str());
-  resetVariables();
-}
-
-// NTP - synchronize system time with NTP server
+// NTP - start synchronizing the system time with NTP server (continues in the background)
 void NTPGetServerTime() {
-  // synchronize system time with NTP server
   configTime(gmtOffset_sec, daylightOffset_sec, NTPServer);
-  delay(5000);
-  if (time(nullptr) > 1000) {
-    Serial.print("Time / successfully synchronized: ");
-    NTPDateTime();
-    Serial.printf("Time / current time as decimal number: %f\n", NTPTimeDecimal());
-    Serial.println("-----");
-  } else {
-    Serial.println("Time / error synchronizing the time, restart attempt...");
-    NTPGetServerTime(); // try again...
-  }
 }
 
-// NTP - output current system time as German date/time stamp
-void NTPDateTime() {
+// NTP - query whether the system time was synchronized
+bool NTPTimeIsSynced() {
+  return ConnectionTimeIsValid(time(nullptr));
+}
+
+// NTP - output current system time as German date/time stamp after 'Prefix'
+void NTPDateTime(const char* Prefix) {
   const char* WeekDays[] = {"Sonntag", "Montag", "Dienstag", "Mittwoch", "Donnerstag", "Freitag", "Samstag"};
   const char* Months[] = {"Januar", "Februar", "März", "April", "Mai", "Juni", "Juli", "August", "September", "Oktober", "November", "Dezember"};
   time_t now;
   struct tm* timeinfo;
   time(&now);
   timeinfo = localtime(&now);
-  Serial.printf("%s, %d. %s %d %02d:%02d:%02d\n",
+  LOG_INFO("%s%s, %d. %s %d %02d:%02d:%02d\n", Prefix,
                 WeekDays[timeinfo->tm_wday],
                 timeinfo->tm_mday,
                 Months[timeinfo->tm_mon],
@@ -586,171 +728,95 @@ void NTPDateTime() {
                 timeinfo->tm_sec);
 }
 
-// NTP - output current system time as decimal number
-float NTPTimeDecimal() {
-  struct tm timeinfo;
-  if(!getLocalTime(&timeinfo)){
-    Serial.println("Time / no system time exists!");
-    return -1;
-  }
-  return float(timeinfo.tm_hour) + float(timeinfo.tm_min)/60;
+// NTP - the system time was set (SNTP task), also after a resync or a manual change
+void NTPTimeSyncNotification(struct timeval* Time) {
+  NTPTimeWasSet.store(true, std::memory_order_relaxed);
+  EventLoopSet(EventLoopWake);
 }
 
-// NTP - check time phase
+// NTP - the next phase transition or midnight was reached (timer task)
+void NTPPhaseTimerCallback(void* Argument) {
+  NTPPhaseTimerExpired.store(true, std::memory_order_relaxed);
+  EventLoopSet(EventLoopPhase);
+}
+
+// NTP - check time phase, the precomputed transitions are only advanced when the phase timer expired
 bool NTPCheckTimePhase() {
-  bool isDayPhase = ((NTPTimeDecimal() >= StartTimeDay && NTPTimeDecimal() < StartTimeNight) ||
-                    (NTPTimeDecimal() >= StartTimeDay && StartTimeNight < StartTimeDay) ||
-                    (NTPTimeDecimal() < StartTimeNight && StartTimeDay > StartTimeNight));
-  TimePhase = isDayPhase ? 1 : 0;
-  return isDayPhase;
-}
-
-// NVS - create, read and edit database variables, type integer
-int NVSControlInteger(const char* DBName, const char* VariableName, bool WritingModeIsActive, int DefaultValue, int NewValue = 999999) {
-  int SavedValue = 999999;
-  int ReturnValue;
-  // query variable in read mode
-  // 'DBName' does not exist
-  if(!preferences.begin(DBName, true)) {
-    Serial.printf("NVS / database '%s' does not exist, therefore the output value: %d\n", DBName, SavedValue);
-    ReturnValue = SavedValue;
-  }
-  // 'DBName' does exist
-  else {
-    SavedValue = preferences.getInt(VariableName, 999999);
-    // 'DBName' does exist + 'VariableName' does not exist
-    if (SavedValue == 999999) {
-      Serial.printf("NVS / variable '%s' does not exist, therefore the output value: %d\n", VariableName, SavedValue);
-      ReturnValue = SavedValue;
-    }
-    // 'DBName' does exist + 'VariableName' does exist
-    else {
-      Serial.printf("NVS / variable '%s' read with value: %d\n", VariableName, SavedValue);
-      ReturnValue = SavedValue;
-    }
-  }
-  // close storage
-  preferences.end();
-
-  // writing mode is active
-  if (WritingModeIsActive) {
-    // if 'DBName' does not exist, it will be automatically created now
-    preferences.begin(DBName, false);
-    // 'VariableName' does exist
-    if (SavedValue != 999999) {
-      // 'VariableName' does exist + 'NewValue' was passed
-      if (NewValue != 999999) {
-        // 'VariableName' does exist + 'NewValue' was passed + 'NewValue' != 'SavedValue'
-        if (SavedValue != NewValue) {
-          // update 'VariableName' with 'NewValue' in database
-          preferences.putInt(VariableName, NewValue);
-          Serial.printf("NVS / variable '%s' overwritten, old value: ", VariableName);
-          Serial.print(SavedValue);
-          Serial.print(", new value: ");
-          Serial.print(NewValue);
-          Serial.println();
-          ReturnValue = NewValue;
-        }
-        // 'VariableName' does exist + 'NewValue' was passed + 'NewValue' = 'SavedValue'
-        else {
-          // no change of 'VariableName' in database
-          Serial.printf("NVS / variable '%s' without change of identical value: ", VariableName);
-          Serial.print(SavedValue);
-          Serial.println();
-          ReturnValue = SavedValue;
-        }
-      }
-      // 'VariableName' does exist + 'NewValue' was not passed
-      else {
-        // no change of 'VariableName' in database
-        Serial.printf("NVS / variable '%s' without change of value: ", VariableName);
-        Serial.print(SavedValue);
-        Serial.println();
-        ReturnValue = SavedValue;
-      }
-    }
-    // 'VariableName' does not exist
-    else {
-      // 'VariableName' does not exist + 'NewValue' was passed
-      if (NewValue != 999999) {
-        // store 'VariableName' with 'NewValue' in database
-        preferences.putInt(VariableName, NewValue);
-        Serial.printf("NVS / variable '%s' created with new value: ", VariableName);
-        Serial.print(NewValue);
-        Serial.println();
-        ReturnValue = NewValue;
-      }
-      // 'VariableName' does not exist + 'NewValue' was not passed
-      else {
-        // store 'VariableName' with 'DefaultValue' in database
-        preferences.putInt(VariableName, DefaultValue);
-        Serial.printf("NVS / variable '%s' created with default value: ", VariableName);
-        Serial.print(DefaultValue);
-        Serial.println();
-        ReturnValue = DefaultValue;
-      }
-    }
-    // close storage
-    preferences.end();
+  if (NTPTimeWasSet.exchange(false, std::memory_order_relaxed)) {
+    PhaseScheduleInvalidate(TimePhaseSchedule);
+  }
+  bool isExpired = NTPPhaseTimerExpired.exchange(false, std::memory_order_relaxed);
+  if (TimePhaseSchedule.isValid && !isExpired) {
+    return TimePhaseSchedule.isDayPhase;
   }
-  return ReturnValue;
+  // transition or midnight reached, schedule changed: take the transitions (one more day after
+  // midnight, all after a change) and start the timer for the next one
+  struct tm timeinfo;
+  if (!getLocalTime(&timeinfo, 0)) {
+    LOG_WARN("Time / no system time exists!\n");
+    return TimePhase == 1;
+  }
+  int64_t Micros = esp_timer_get_time();
+  PhaseScheduleAdvance(TimePhaseSchedule, Settings.Rules, StartTimeDay, StartTimeNight, mktime(&timeinfo), Micros);
+  TimePhase = TimePhaseSchedule.isDayPhase ? 1 : 0;
+  int64_t Delay = TimePhaseSchedule.DeadlineMicros - Micros;
+  esp_timer_stop(NTPPhaseTimer);
+  esp_timer_start_once(NTPPhaseTimer, Delay > 0 ? Delay : 1);
+  LOG_DEBUG("Time / %s phase, %d transitions pending, next timer in %d s\n", TimePhaseSchedule.isDayPhase ? "day" : "night",
+            TimePhaseSchedule.Count, (int)(Delay / 1000000));
+  return TimePhaseSchedule.isDayPhase;
 }
 
-// NVS - read stored values from NVS depending on daytime
+// NVS - read settings from the RAM cache of the NVS database
 void NVSReadSettings(bool ReadTimeSettings, bool ReadTimePhaseSettings) {
   if (ReadTimeSettings) {
-    StartTimeDayHours = NVSControlInteger(NVSDBName, NVSVarStartTimeDayHours, true, NVSStdStartTimeDayHours);
-    StartTimeDayMinutes = NVSControlInteger(NVSDBName, NVSVarStartTimeDayMinutes, true, NVSStdStartTimeDayMinutes);
-    StartTimeNightHours = NVSControlInteger(NVSDBName, NVSVarStartTimeNightHours, true, NVSStdStartTimeNightHours);
-    StartTimeNightMinutes = NVSControlInteger(NVSDBName, NVSVarStartTimeNightMinutes, true, NVSStdStartTimeNightMinutes);
-    // build floats for easier comparison with actual time
-    StartTimeDay = StartTimeDayHours + static_cast<float>(StartTimeDayMinutes) / 60.0;
-    StartTimeNight = StartTimeNightHours + static_cast<float>(StartTimeNightMinutes) / 60.0;
-    Serial.println("-----");
-    Serial.println("Configuration / timer settings loaded!");
-    Serial.println("-----");
+    StartTimeDayHours = Settings.Value[SettingStartTimeDayHours];
+    StartTimeDayMinutes = Settings.Value[SettingStartTimeDayMinutes];
+    StartTimeNightHours = Settings.Value[SettingStartTimeNightHours];
+    StartTimeNightMinutes = Settings.Value[SettingStartTimeNightMinutes];
+    TransitionMinutes = Settings.Value[SettingTransitionMinutes];
+    // minutes of the day for the phase schedule, the transitions are compiled again
+    StartTimeDay = StartTimeDayHours * 60 + StartTimeDayMinutes;
+    StartTimeNight = StartTimeNightHours * 60 + StartTimeNightMinutes;
+    PhaseScheduleInvalidate(TimePhaseSchedule);
+    LOG_INFO("-----\n");
+    LOG_INFO("Configuration / timer settings loaded!\n");
+    LOG_INFO("-----\n");
   }
   if (ReadTimePhaseSettings) {
     // check time phase
     bool isDayPhase = NTPCheckTimePhase();
-    if (isDayPhase) {
-      LEDStatus = NVSControlInteger(NVSDBName, NVSVarLEDStatusDay, true, NVSStdLEDStatusDay);
-      LEDBrightness = NVSControlInteger(NVSDBName, NVSVarLEDBrightnessDay, true, NVSStdLEDBrightnessDay);
-      LEDAmplifier = NVSControlInteger(NVSDBName, NVSVarLEDAmplifierDay, true, NVSStdLEDAmplifierDay);
-      LEDTauThousand = NVSControlInteger(NVSDBName, NVSVarLEDTauDay, true, NVSStdLEDTauDay);
-      // build float (devide integer by 1000) for LED program
-      LEDTau = LEDTauThousand / 1000.0;
-      LEDColorTopR = NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayR, true, NVSStdLEDColorTopDayR);
-      LEDColorTopG = NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayG, true, NVSStdLEDColorTopDayG);
-      LEDColorTopB = NVSControlInteger(NVSDBName, NVSVarLEDColorTopDayB, true, NVSStdLEDColorTopDayB);
-      LEDColorBottomR = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayR, true, NVSStdLEDColorBottomDayR);
-      LEDColorBottomG = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayG, true, NVSStdLEDColorBottomDayG);
-      LEDColorBottomB = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomDayB, true, NVSStdLEDColorBottomDayB);
-      LEDColorWhite = NVSControlInteger(NVSDBName, NVSVarLEDColorWhiteDay, true, NVSStdLEDColorWhiteDay);
-      MQTTSendSettings();
-      Serial.println("-----");
-      Serial.println("Configuration / daytime LED settings loaded!");
-      Serial.println("-----");
-    }
-    else {
-      LEDStatus = NVSControlInteger(NVSDBName, NVSVarLEDStatusNight, true, NVSStdLEDStatusNight);
-      LEDBrightness = NVSControlInteger(NVSDBName, NVSVarLEDBrightnessNight, true, NVSStdLEDBrightnessNight);
-      LEDAmplifier = NVSControlInteger(NVSDBName, NVSVarLEDAmplifierNight, true, NVSStdLEDAmplifierNight);
-      LEDTauThousand = NVSControlInteger(NVSDBName, NVSVarLEDTauNight, true, NVSStdLEDTauNight);
-      // build float (devide integer by 1000) for LED program
-      LEDTau = LEDTauThousand / 1000.0;
-      LEDColorTopR = NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightR, true, NVSStdLEDColorTopNightR);
-      LEDColorTopG = NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightG, true, NVSStdLEDColorTopNightG);
-      LEDColorTopB = NVSControlInteger(NVSDBName, NVSVarLEDColorTopNightB, true, NVSStdLEDColorTopNightB);
-      LEDColorBottomR = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightR, true, NVSStdLEDColorBottomNightR);
-      LEDColorBottomG = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightG, true, NVSStdLEDColorBottomNightG);
-      LEDColorBottomB = NVSControlInteger(NVSDBName, NVSVarLEDColorBottomNightB, true, NVSStdLEDColorBottomNightB);
-      LEDColorWhite = NVSControlInteger(NVSDBName, NVSVarLEDColorWhiteNight, true, NVSStdLEDColorWhiteNight);
-      MQTTSendSettings();
-      Serial.println("-----");
-      Serial.println("Configuration / nighttime LED settings loaded!");
-      Serial.println("-----");
+    // read all LED settings of the active time phase
+    for (int i = 0; i < LightSceneValueCount; ++i) {
+      *LEDSceneValue[i] = Settings.Value[SettingScene(isDayPhase, i)];
     }
+    // build float (devide integer by 1000) for LED program
+    LEDTau = LEDTauThousand / 1000.0;
+    MQTTSendSettings(MQTTPublishChanged);
+    LOG_INFO("-----\n");
+    LOG_INFO("Configuration / %s LED settings loaded!\n", isDayPhase ? "daytime" : "nighttime");
+    LOG_INFO("-----\n");
+  }
+}
+
+// NVS - store one LED setting of the active time phase in the NVS cache
+void NVSWriteSceneValue(int Index, bool isDayPhase) {
+  SettingsStoreSet(Settings, SettingScene(isDayPhase, Index), *LEDSceneValue[Index], millis());
+}
+
+// NVS - load all settings into the NVS cache (one read of the settings blob)
+void NVSLoadSettings() {
+  const char* Sources[] = {"settings blob", "legacy variables (migrated with the next commit)", "standard values"};
+  SettingsSource Source = SettingsStoreLoad(Settings, preferences, NVSDBName, NVSVarSettings, NVSFields, NVSVarTimeline);
+  LOG_INFO("NVS / %d settings, %d keyframes and %d phase rules loaded from %s\n", SettingCount, Settings.Timeline.Count,
+           Settings.Rules.Count, Sources[Source]);
+}
+
+// NVS - commit the changed settings of the NVS cache once they are no longer changing
+void NVSCommitService() {
+  if (SettingsStoreService(Settings, preferences, millis(), NVSCommitQuietMillis, NVSCommitMaxDelayMillis)) {
+    LOG_INFO("NVS / settings blob '%s' committed (%u writes since boot)\n", NVSVarSettings, (unsigned)Settings.WriteCount);
+    LOG_INFO("-----\n");
   }
 }
 
@@ -770,41 +836,31 @@ void EmptySerialBuffer() {
   }
 }
 
+// loop - longest sleep of the event-driven 'loop()' until its next own deadline (MQTT data, the
+// phase timer and WiFi events end the sleep earlier)
+uint32_t LoopWaitMillis() {
+  uint32_t Wait = NetworkLink.State == ConnectionOnline ? EventLoopIdleMillis : EventLoopConnectMillis;
+  // pending render command, posted after the frame interval
+  if (LEDCommandIsPending) {
+    uint32_t Elapsed = millis() - LEDCommandLastPostMillis;
+    uint32_t Remaining = Elapsed < LEDCommandPostMillis ? LEDCommandPostMillis - Elapsed : 0;
+    Wait = Remaining < Wait ? Remaining : Wait;
+  }
+  return Wait;
+}
+
 // a function to create mesmerizing LED brilliance and vibrant color shifts,
 // setting the perfect mood for contented shrimps to thrive
-void LEDColorControl() {
-  int LEDColorTopNewR;
-  int LEDColorTopNewG;
-  int LEDColorTopNewB;
-  int LEDColorBottomNewR;
-  int LEDColorBottomNewG;
-  int LEDColorBottomNewB;
-  int LEDColorWLimit;
-  int LEDColorWMax = 0;
-  double LEDColorWBalanceFactor;
-  int LEDColorDeltaR;
-  int LEDColorDeltaG;
-  int LEDColorDeltaB;
+void LEDColorRender(int Strip, LEDFrame& Frame, const LightScene& Scene) {
+  const LEDStripConfig& Config = LEDStrips[Strip];
+  // gradient profile of the strip
+  int16_t Value[LightSceneValueCount];
+  memcpy(Value, Scene.Value, sizeof(Value));
+  Value[LightBrightness] = Value[LightBrightness] * Config.BrightnessPercent / 100;
+  int32_t TauThousand = (int32_t)Value[LightTauThousand] * Config.TauPercent / 100;
+  Value[LightTauThousand] = TauThousand < 1 ? 1 : TauThousand > 32767 ? 32767 : TauThousand;
+  LEDGradientColors Gradient;
   double LEDBrightnessReduceFactor;
-  double LEDAmplifierYFast;
-  double LEDAmplifierYSlow;
-  double LEDAmplifierYLinear;
-  double LEDAmplifierY;
-  int LEDColorTempR;
-  int LEDColorTempG;
-  int LEDColorTempB;
-  int LEDColorTempW;
-
-  // internal lambda function for limiting led color values to 255
-  auto LimitTo255 = [](double Value) -> int {
-    if (Value < 0) {
-      Value = 0;
-    }
-    else if (Value > 255) {
-      Value = 255;
-    }
-    return static_cast<int>(Value);
-  };
 
   // internal lambda function for limiting led color brightness
   auto CalculateBrigthnessReduceFactor = [&](int R, int G, int B) -> double {
@@ -816,9 +872,10 @@ void LEDColorControl() {
     if (B > LEDColorMaxFound) {
       LEDColorMaxFound = B;
     }
-    int LEDColorLimit = static_cast<int>(255 * LEDBrightness / 100);
+    // without rounding, low brightness values keep their fraction in the 8.8 channels
+    double LEDColorLimit = 255.0 * Value[LightBrightness] / 100;
     if (LEDColorMaxFound > LEDColorLimit) {
-      reduceFactor = static_cast<double>(LEDColorLimit) / LEDColorMaxFound;
+      reduceFactor = LEDColorLimit / LEDColorMaxFound;
     }
     else {
       reduceFactor = 1.0;
@@ -826,100 +883,377 @@ void LEDColorControl() {
     return reduceFactor;
   };
 
-  if (LEDStatus != 0) {
-    LEDBrightnessReduceFactor = CalculateBrigthnessReduceFactor(LEDColorBottomR, LEDColorBottomG, LEDColorBottomB);
-    LEDColorBottomNewR = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorBottomR));
-    LEDColorBottomNewG = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorBottomG));
-    LEDColorBottomNewB = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorBottomB));
-    
-    LEDBrightnessReduceFactor = CalculateBrigthnessReduceFactor(LEDColorTopR, LEDColorTopG, LEDColorTopB);
-    LEDColorTopNewR = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorTopR));
-    LEDColorTopNewG = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorTopG));
-    LEDColorTopNewB = static_cast<int>(LEDBrightnessReduceFactor * static_cast<double>(LEDColorTopB));
+  if (Value[LightStatus] != 0) {
+    LEDBrightnessReduceFactor = CalculateBrigthnessReduceFactor(Value[LightColorBottomR], Value[LightColorBottomG], Value[LightColorBottomB]);
+    Gradient.BottomR = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorBottomR] * LEDChannelOne);
+    Gradient.BottomG = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorBottomG] * LEDChannelOne);
+    Gradient.BottomB = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorBottomB] * LEDChannelOne);
     
-    LEDColorDeltaR = LEDColorBottomNewR - LEDColorTopNewR;
-    LEDColorDeltaG = LEDColorBottomNewG - LEDColorTopNewG;
-    LEDColorDeltaB = LEDColorBottomNewB - LEDColorTopNewB;
+    LEDBrightnessReduceFactor = CalculateBrigthnessReduceFactor(Value[LightColorTopR], Value[LightColorTopG], Value[LightColorTopB]);
+    Gradient.TopR = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorTopR] * LEDChannelOne);
+    Gradient.TopG = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorTopG] * LEDChannelOne);
+    Gradient.TopB = static_cast<int>(LEDBrightnessReduceFactor * Value[LightColorTopB] * LEDChannelOne);
 
-    LEDColorWLimit = 255 * LEDColorWhite / 100.0;
-    
-    Serial.println("LED / starting the LED strip configuration...");
-    Serial.println("-----");
-    // the first 'for' loop only calculates the maximum average 'LEDColorWMax'
-    for (int i = 1; i <= LEDPixelCount; ++i) {
-      if (i == 1) {
-        LEDColorTempR = LEDColorBottomNewR;
-        LEDColorTempG = LEDColorBottomNewG;
-        LEDColorTempB = LEDColorBottomNewB;
-      }
-      else if (i > 1 && i != LEDPixelCount) {
-        LEDAmplifierYFast = 1 - exp((-i + 1) / LEDTau);
-        LEDAmplifierYSlow = (1.0 / exp(1.0 / LEDTau * LEDPixelCount)) * exp(1.0 / LEDTau * i);
-        LEDAmplifierYLinear = (1.0 / (LEDPixelCount - 1)) * i - (1.0 / (LEDPixelCount - 1));
-        if (LEDAmplifier >= 0) {
-          LEDAmplifierY = LEDAmplifierYFast * LEDAmplifier / 100 + LEDAmplifierYLinear * (100 - LEDAmplifier) / 100;
-        } else {
-          LEDAmplifierY = LEDAmplifierYSlow * abs(LEDAmplifier) / 100 + LEDAmplifierYLinear * (100 - abs(LEDAmplifier)) / 100;
-        }
-        LEDColorTempR = LimitTo255(LEDColorBottomNewR - LEDColorDeltaR * LEDAmplifierY);
-        LEDColorTempG = LimitTo255(LEDColorBottomNewG - LEDColorDeltaG * LEDAmplifierY);
-        LEDColorTempB = LimitTo255(LEDColorBottomNewB - LEDColorDeltaB * LEDAmplifierY);
+    Gradient.WLimit = LEDChannelMax * Value[LightColorWhite] / 100.0;
+    Gradient.Amplifier = Value[LightAmplifier];
+    Gradient.TauThousand = Value[LightTauThousand];
+
+    // the renderer of the strip rebuilds the curve table only if 'LEDAmplifier' or 'LEDTauThousand'
+    // changed, calculates R/G/B once and fills in the balanced white (RGBW strips only)
+    LEDStripRenderers::Renderer[Strip].Render(Frame, LEDCurve[Strip], Gradient);
+  }
+  else {
+    // set the color of each led to '0'
+    LEDStripRenderers::Renderer[Strip].Clear(Frame);
+  }
+}
+
+// LED - transfer one frame per strip to 'LEDStrip' and activate them, the X8 method starts one
+// parallel DMA transfer of all strips with the 'Show()' of the last one; the 8.8 channels are
+// dithered to 8 bits (or rounded), frames with fractions are refreshed every 'LEDDitherFrameMillis'
+void LEDStripShowFrames(const LEDFrame* Frames, bool isDithered) {
+  bool hasFraction = false;
+  for (int s = 0; s < LEDStripCount; ++s) {
+    const LEDFrame& Frame = Frames[s];
+    int Last = Frame.PixelCount - 1;
+    for (int i = 0; i < Frame.PixelCount; ++i) {
+      LEDPixelOutput Pixel;
+      if (isDithered && LEDDitherFrameMillis > 0) {
+        hasFraction |= LEDDitherPixel(Frame.Pixel[i], LEDDither[s].Error[i], Pixel,
+                                      LEDDitherMaxLevel << LEDChannelFractionBits);
       }
       else {
-        LEDColorTempR = LEDColorTopNewR;
-        LEDColorTempG = LEDColorTopNewG;
-        LEDColorTempB = LEDColorTopNewB;
-      }
-      LEDColorTempW = (LEDColorTempR + LEDColorTempG + LEDColorTempB) / 3;
-      if (LEDColorTempW > LEDColorWMax) {
-        LEDColorWMax = LEDColorTempW;
+        LEDDitherRound(Frame.Pixel[i], Pixel);
       }
+      // configure the strip
+      LEDStrip[s]->SetPixelColor(LEDStrips[s].isReversed ? Last - i : i, LEDStripOutput<LEDStripColor>::Pixel(Pixel));
+    }
+  }
+  LEDDitherIsActive = hasFraction;
+  LEDDitherLastMillis = millis();
+  LEDDitherRefreshCount = 0;
+  // activate all strips
+  for (int s = 0; s < LEDStripCount; ++s) {
+    LEDStrip[s]->Show();
+  }
+}
+
+// LED - take over rendered frames as the frames shown, returns true if a frame changed (render task)
+bool LEDSwapFrames(const LEDFrame* Frames) {
+  bool isChanged = false;
+  for (int s = 0; s < LEDStripCount; ++s) {
+    // new settings replace a running cross-fade immediately (the frame shown differs from its target)
+    isChanged |= LEDFade[s].isActive;
+    LEDFade[s].isActive = false;
+    // the new frame is compared with the one shown
+    const LEDFrame& Frame = Frames[s];
+    if (Frame.PixelCount != LEDFrameBuffer[s].PixelCount ||
+        memcmp(Frame.Pixel, LEDFrameBuffer[s].Pixel, sizeof(LEDPixel) * Frame.PixelCount) != 0) {
+      memcpy(&LEDFrameBuffer[s], &Frame, sizeof(LEDFrame));
+      isChanged = true;
+    }
+  }
+  return isChanged;
+}
+
+// LED - render a settings snapshot into the frame buffers, returns true if a frame changed (render task)
+bool LEDRenderFrames(const LightScene& Scene) {
+  // the target frames are free outside of a cross-fade, a running one ends with the swap
+  for (int s = 0; s < LEDStripCount; ++s) {
+    LEDColorRender(s, LEDFrameTarget[s], Scene);
+  }
+  return LEDSwapFrames(LEDFrameTarget);
+}
+
+// LED - render a settings snapshot into the frame buffer and show it if it changed (render task)
+void LEDColorControl(const LightScene& Scene) {
+  LOG_INFO("LED / starting the LED strip configuration...\n");
+  LOG_INFO("-----\n");
+  if (!LEDRenderFrames(Scene)) {
+    DIAGNOSTICS_SHOW_SKIPPED();
+    LOG_INFO("LED / the LED strip configuration is unchanged!\n");
+    LOG_INFO("-----\n");
+    return;
+  }
+#if LOG_LEVEL >= LOG_LEVEL_TRACE && (LOG_TRACE_CATEGORIES & LOG_CATEGORY_PIXEL)
+  for (int s = 0; s < LEDStripCount; ++s) {
+    for (int i = 0; i < LEDFrameBuffer[s].PixelCount; ++i) {
+      const LEDPixel& Pixel = LEDFrameBuffer[s].Pixel[i];
+      LOG_TRACE(LOG_CATEGORY_PIXEL, "LED / %d/%2d: [%5d,%5d,%5d,%5d]\n", s, i, Pixel.R, Pixel.G, Pixel.B, Pixel.W);
     }
-    LEDColorWBalanceFactor = static_cast<double>(LEDColorWLimit) / static_cast<double>(LEDColorWMax);
-    // the second 'for' loop calculates all colors as before, but also the balanced white
-    for (int i = 1; i <= LEDPixelCount; ++i) {
-      if (i == 1) {
-        LEDColorTempR = LEDColorBottomNewR;
-        LEDColorTempG = LEDColorBottomNewG;
-        LEDColorTempB = LEDColorBottomNewB;
+  }
+#endif
+  LEDStripShowFrames(LEDFrameBuffer);
+  LOG_INFO("-----\n");
+  LOG_INFO("LED / the LED strip configuration is activated!\n");
+  LOG_INFO("-----\n");
+}
+
+// LED - cross-fade from the frame shown to a settings snapshot within 'Minutes' (render task)
+void LEDColorFade(const LightScene& Scene, int Minutes) {
+  // nothing shown yet (after boot) or cross-fade disabled: switch immediately
+  if (Minutes <= 0 || LEDFrameBuffer[0].PixelCount == 0) {
+    LEDColorControl(Scene);
+    return;
+  }
+  uint32_t Now = millis();
+  for (int s = 0; s < LEDStripCount; ++s) {
+    LEDColorRender(s, LEDFrameTarget[s], Scene);
+    LEDTransitionStart(LEDFade[s], LEDFrameBuffer[s], LEDFrameTarget[s], Now, static_cast<uint32_t>(Minutes) * 60000UL);
+  }
+  LOG_INFO("LED / cross-fade started, duration: %d min\n", Minutes);
+  LOG_INFO("-----\n");
+}
+
+// LED - advance a running cross-fade without blocking (render task)
+void LEDTransitionService() {
+  DIAGNOSTICS_START(RenderStart);
+  // all cross-fades share start and duration, so they step and complete together
+  uint32_t Now = millis();
+  bool isStepped = false;
+  for (int s = 0; s < LEDStripCount; ++s) {
+    isStepped |= LEDTransitionStep(LEDFade[s], LEDFrameBuffer[s], Now, LEDTransitionFrameMillis);
+  }
+  if (isStepped) {
+    LEDStripShowFrames(LEDFrameBuffer);
+    DIAGNOSTICS_RENDER(RenderStart);
+    if (!LEDFade[0].isActive) {
+      LOG_INFO("LED / cross-fade completed!\n");
+      LOG_INFO("-----\n");
+    }
+  }
+}
+
+// LED - show the frames again while they have fractional channels, the dithered output averages
+// to the 8.8 values; after 'LEDDitherFrameLimit' refreshes they are shown rounded once and the
+// output stops (render task)
+void LEDDitherService() {
+  if (!LEDDitherIsActive || millis() - LEDDitherLastMillis < (uint32_t)LEDDitherFrameMillis) {
+    return;
+  }
+  uint32_t RefreshCount = LEDDitherRefreshCount + 1;
+  bool isDithered = LEDDitherFrameLimit == 0 || RefreshCount < (uint32_t)LEDDitherFrameLimit;
+  DIAGNOSTICS_START(RenderStart);
+  LEDStripShowFrames(LEDFrameBuffer, isDithered);
+  DIAGNOSTICS_RENDER(RenderStart);
+  LEDDitherRefreshCount = RefreshCount;
+}
+
+// LED - execute a render command (render task)
+void LEDCommandExecute(const LEDCommand& Command) {
+  DIAGNOSTICS_START(RenderStart);
+  if (Command.Type == LEDCommandFade) {
+    LEDColorFade(Command.Scene, Command.TransitionMinutes);
+  }
+  else if (Command.Type == LEDCommandTimeline) {
+    // timeline steps are frequent, therefore without pixel output
+    if (LEDRenderFrames(Command.Scene)) {
+      LEDStripShowFrames(LEDFrameBuffer);
+    }
+    else {
+      DIAGNOSTICS_SHOW_SKIPPED();
+    }
+  }
+  else {
+    LEDColorControl(Command.Scene);
+  }
+  DIAGNOSTICS_RENDER(RenderStart);
+}
+
+// LED - keep a command until its apply time, a 'Show' command is rendered now, so only the swap of
+// the frames is left at the instant (render task)
+void LEDStageCommand(const LEDCommand& Command) {
+  LEDCommandStaged = Command;
+  LEDStageIsPending = true;
+  if (Command.Type == LEDCommandShow) {
+    for (int s = 0; s < LEDStripCount; ++s) {
+      LEDColorRender(s, LEDFrameStaged[s], Command.Scene);
+    }
+  }
+  LOG_INFO("LED / LED strip configuration staged, applied in %d ms\n",
+           (int)((Command.ApplyMicros - esp_timer_get_time()) / 1000));
+  LOG_INFO("-----\n");
+}
+
+// LED - execute the staged command at its apply time (render task)
+void LEDStageService() {
+  if (!LEDStageIsPending || LEDCommandStaged.ApplyMicros - esp_timer_get_time() > LEDApplySpinMicros) {
+    return;
+  }
+  // whole ticks are slept, only the rest below one tick is waited actively (bounded to the remaining
+  // time), so all members of a group switch together
+  int64_t Remaining = LEDCommandStaged.ApplyMicros - esp_timer_get_time();
+  while (Remaining >= (int64_t)portTICK_PERIOD_MS * 1000) {
+    vTaskDelay(1);
+    Remaining = LEDCommandStaged.ApplyMicros - esp_timer_get_time();
+  }
+  if (Remaining > 0) {
+    delayMicroseconds((uint32_t)Remaining);
+  }
+  LEDStageIsPending = false;
+  if (LEDCommandStaged.Type != LEDCommandShow) {
+    LEDCommandExecute(LEDCommandStaged);
+    return;
+  }
+  DIAGNOSTICS_START(RenderStart);
+  if (!LEDSwapFrames(LEDFrameStaged)) {
+    DIAGNOSTICS_SHOW_SKIPPED();
+    LOG_INFO("LED / the staged LED strip configuration is unchanged!\n");
+    LOG_INFO("-----\n");
+    return;
+  }
+  LEDStripShowFrames(LEDFrameBuffer);
+  DIAGNOSTICS_RENDER(RenderStart);
+  LOG_INFO("LED / the staged LED strip configuration is activated!\n");
+  LOG_INFO("-----\n");
+}
+
+// LED - render task, owns 'LEDStrip' and all frames, executes the posted commands
+void LEDRenderTask(void* Parameter) {
+  LEDCommand Command;
+  // initialize 'LEDStrip' on the render core, the strips take the parallel channels in this order
+  for (int s = 0; s < LEDStripCount; ++s) {
+    LEDStrip[s] = new LEDStripBus(LEDStrips[s].PixelCount, LEDStrips[s].Pin);
+    LEDStrip[s]->Begin();
+    LEDDitherReset(LEDDither[s]);
+  }
+  for (int s = 0; s < LEDStripCount; ++s) {
+    LEDStrip[s]->Show();
+  }
+#ifdef BENCHMARK
+  // render path benchmarks, before the first command
+  BenchmarkRenderPath(LEDDitherFrameMillis, LEDStripsPixelCount(0));
+#endif
+  for (;;) {
+    // sleep until a command is posted, during dithering or a cross-fade until the next frame is due
+    TickType_t Wait = portMAX_DELAY;
+    if (LEDDitherIsActive) {
+      uint32_t Elapsed = millis() - LEDDitherLastMillis;
+      Wait = pdMS_TO_TICKS(Elapsed < (uint32_t)LEDDitherFrameMillis ? LEDDitherFrameMillis - Elapsed : 0);
+    }
+    else if (LEDFade[0].isActive) {
+      Wait = pdMS_TO_TICKS(LEDTransitionFrameMillis);
+    }
+    else {
+      // idle: once the parallel transfer of the last frame is complete, light sleep may stop the
+      // clocks (the strips keep the latched pixels)
+      while (!LEDStrip[0]->CanShow()) {
+        vTaskDelay(1);
       }
-      else if (i > 1 && i != LEDPixelCount) {
-        LEDAmplifierYFast = 1 - exp((-i + 1) / LEDTau);
-        LEDAmplifierYSlow = (1.0 / exp(1.0 / LEDTau * LEDPixelCount)) * exp(1.0 / LEDTau * i);
-        LEDAmplifierYLinear = (1.0 / (LEDPixelCount - 1)) * i - (1.0 / (LEDPixelCount - 1));
-        if (LEDAmplifier >= 0) {
-          LEDAmplifierY = LEDAmplifierYFast * LEDAmplifier / 100 + LEDAmplifierYLinear * (100 - LEDAmplifier) / 100;
-        } else {
-          LEDAmplifierY = LEDAmplifierYSlow * abs(LEDAmplifier) / 100 + LEDAmplifierYLinear * (100 - abs(LEDAmplifier)) / 100;
-        }
-        LEDColorTempR = LimitTo255(LEDColorBottomNewR - LEDColorDeltaR * LEDAmplifierY);
-        LEDColorTempG = LimitTo255(LEDColorBottomNewG - LEDColorDeltaG * LEDAmplifierY);
-        LEDColorTempB = LimitTo255(LEDColorBottomNewB - LEDColorDeltaB * LEDAmplifierY);
+      EventLoopFrameLock(false);
+    }
+    if (LEDStageIsPending) {
+      // wake up shortly before the apply time of the staged command
+      int64_t Remaining = LEDCommandStaged.ApplyMicros - LEDApplySpinMicros - esp_timer_get_time();
+      TickType_t Until = pdMS_TO_TICKS(Remaining > 0 ? (uint32_t)(Remaining / 1000) : 0);
+      Wait = Until < Wait ? Until : Wait;
+    }
+    ulTaskNotifyTake(pdTRUE, Wait);
+    EventLoopFrameLock(true);
+    // only the newest command of a burst is executed and the newest one with an apply time ahead is
+    // staged, older ones are outdated
+    bool hasCommand = false;
+    bool hasTimed = false;
+    LEDCommand Timed;
+    LEDCommand Next;
+    while (LEDCommandQueue.Pop(Next)) {
+      if (Next.ApplyMicros > esp_timer_get_time()) {
+        Timed = Next;
+        hasTimed = true;
       }
       else {
-        LEDColorTempR = LEDColorTopNewR;
-        LEDColorTempG = LEDColorTopNewG;
-        LEDColorTempB = LEDColorTopNewB;
+        Command = Next;
+        hasCommand = true;
       }
-      LEDColorTempW = LimitTo255(((LEDColorTempR + LEDColorTempG + LEDColorTempB) / 3) * LEDColorWBalanceFactor);
-      // configure the 'LEDStrip'
-      LEDStrip.SetPixelColor(i-1, RgbwColor(LEDColorTempR, LEDColorTempG, LEDColorTempB, LEDColorTempW));
-      Serial.printf("LED / %2d: [%3d,%3d,%3d,%3d]\n", i-1, LEDColorTempR, LEDColorTempG, LEDColorTempB, LEDColorTempW);
     }
-  }
-  else {
-    // set the color of each led to '0'
-    for (int i = 1; i <= LEDPixelCount; ++i) {
-      // configure the 'LEDStrip'
-      LEDStrip.SetPixelColor(i-1, RgbwColor(0, 0, 0, 0));
-      Serial.printf("LED / %2d: [  0,  0,  0,  0]\n", i-1);
+    if (hasCommand) {
+      LEDCommandExecute(Command);
     }
+    // a staged command is only replaced by a newer one with its own apply time, commands without
+    // (timeline, fades, direct settings) are executed and it stays pending
+    if (hasTimed) {
+      LEDStageCommand(Timed);
+    }
+    LEDStageService();
+    LEDTransitionService();
+    LEDDitherService();
   }
-  // activate the 'LEDStrip'
-  LEDStrip.Show();
-  Serial.println("-----");
-  Serial.println("LED / the LED strip configuration is activated!");
-  Serial.println("-----");
+}
+
+// LED - current settings as immutable snapshot for the render task
+LightScene LEDSceneCapture() {
+  LightScene Scene;
+  for (int i = 0; i < LightSceneValueCount; ++i) {
+    Scene.Value[i] = *LEDSceneValue[i];
+  }
+  return Scene;
+}
+
+// LED - post a command to the render task, the newest command stays pending during the frame
+// interval after a post or while the queue is full
+void LEDRequest(LEDCommandType Type, const LightScene& Scene) {
+  // a pending command with an apply time is posted before a command without one takes its place
+  if (LEDCommandIsPending && LEDCommandPending.ApplyMicros != 0 && LEDApplyMicros == 0 &&
+      LEDCommandQueue.Push(LEDCommandPending)) {
+    LEDCommandLastPostMillis = millis();
+    xTaskNotifyGive(LEDRenderTaskHandle);
+  }
+  LEDCommandPending.Type = Type;
+  LEDCommandPending.TransitionMinutes = TransitionMinutes;
+  LEDCommandPending.Scene = Scene;
+  LEDCommandPending.ApplyMicros = LEDApplyMicros;
+  LEDCommandIsPending = true;
+  LEDRequestFlush();
+}
+
+// LED - post a pending command once the frame interval elapsed (network/config task)
+void LEDRequestFlush() {
+  if (!LEDCommandIsPending || millis() - LEDCommandLastPostMillis < LEDCommandPostMillis) {
+    return;
+  }
+  if (LEDCommandQueue.Push(LEDCommandPending)) {
+    LEDCommandIsPending = false;
+    LEDCommandLastPostMillis = millis();
+    xTaskNotifyGive(LEDRenderTaskHandle);
+  }
+}
+
+// LED - render the current settings immediately
+void LEDColorControl() {
+  LEDRequest(LEDCommandShow, LEDSceneCapture());
+}
+
+// LED - cross-fade to the current settings within 'TransitionMinutes'
+void LEDColorFade() {
+  LEDRequest(LEDCommandFade, LEDSceneCapture());
+}
+
+// LED - post the interpolated scene of the light timeline, evaluated once per 'LEDTimelineUpdateMillis'
+void LEDTimelineService() {
+  if (LEDTimelineSceneValid && millis() - LEDTimelineLastMillis < LEDTimelineUpdateMillis) {
+    return;
+  }
+  LEDTimelineLastMillis = millis();
+  struct tm timeinfo;
+  if (!getLocalTime(&timeinfo, 0)) {
+    return;
+  }
+  LightScene Scene;
+  int32_t Second = timeinfo.tm_hour * 3600L + timeinfo.tm_min * 60L + timeinfo.tm_sec;
+  if (!LightTimelineEvaluate(Settings.Timeline, Second, Scene)) {
+    return;
+  }
+  // render only if the interpolated scene changed
+  if (LEDTimelineSceneValid && memcmp(&Scene, &LEDTimelineScene, sizeof(LightScene)) == 0) {
+    return;
+  }
+  LEDTimelineScene = Scene;
+  LEDTimelineSceneValid = true;
+  for (int i = 0; i < LightSceneValueCount; ++i) {
+    *LEDSceneValue[i] = Scene.Value[i];
+  }
+  LEDTau = LEDTauThousand / 1000.0;
+  LEDRequest(LEDCommandTimeline, Scene);
 }
 
 // -------------------------------------------------------------------
@@ -927,7 +1261,9 @@ void LEDColorControl() {
 // -------------------------------------------------------------------
 void setup() {
   Serial.begin(115200);
-  Serial.println("-----");
+  // lines are buffered from here on and written by a low-priority task
+  LogBegin(LogTaskStackSize, LogTaskPriority, LogTaskCore);
+  LOG_INFO("-----\n");
   // to format the NVS, comment out the following line
   // NVSFormat();
 
@@ -935,34 +1271,85 @@ void setup() {
   pinMode(LED_BUILTIN, OUTPUT);
   digitalWrite(LED_BUILTIN, LOW);
   
-  // establishing of connections (WiFi, MTTQ, NTP)
-  WiFiEventHandlersSetup();
-  WiFiStartConnection();
-  
-  // wait for 'WiFiActions' to complete
-  while (isConnecting) {
-    delay(100); // short delay to avoid unnecessary load on CPU
+  // MQTT - hash index for the topic dispatch, topic namespace of this device
+  if (!MQTTTopicIndexBuild(MQTTTopicTable, MQTTTopics, MQTTTopicCount)) {
+    // without the index no command is dispatched, stop once the log task has written the error
+    LOG_ERROR("MQTT / too many topics for the topic index (%d)!\n", MQTTTopicCount);
+    delay(100);
+    abort();
   }
+  MQTTDeviceSetup();
 
-  // NVS - read time settings
-  NVSReadSettings(true, false);
+#if EVENT_LOOP
+  // 'loop()' sleeps until events arrive, the chip enters light sleep while all tasks wait
+  EventLoopBegin(EventLoopLightSleep, EventLoopWatcherStackSize, EventLoopWatcherPriority, EventLoopWatcherCore);
+#endif
 
-  // initialize 'LEDStrip'
-  LEDStrip.Begin();
-  LEDStrip.Show();
+  // establishing of connections (WiFi, NTP, MQTT) is done by 'loop()' without waiting, the
+  // backoff jitter differs per device
+  NetworkLink.JitterState = esp_random();
+  WiFiEventHandlersSetup();
+  // NTP - every setting of the system time invalidates the phase transitions, the phase timer
+  // replaces polling the time in 'loop()'
+  sntp_set_time_sync_notification_cb(NTPTimeSyncNotification);
+  const esp_timer_create_args_t PhaseTimerArgs = {NTPPhaseTimerCallback, nullptr, ESP_TIMER_TASK, "PhaseTimer", false};
+  esp_timer_create(&PhaseTimerArgs, &NTPPhaseTimer);
 
-  delay(2000);
+  // NVS - load all settings once, then read time settings from RAM
+  NVSLoadSettings();
+  NVSReadSettings(true, false);
 
+  // start the render task on the application core, it initializes and owns 'LEDStrip'
+  xTaskCreatePinnedToCore(LEDRenderTask, "LEDRender", LEDRenderTaskStackSize, nullptr,
+                          LEDRenderTaskPriority, &LEDRenderTaskHandle, LEDRenderTaskCore);
 }
 
 // -------------------------------------------------------------------
-// program code for infinite loop
+// program code for infinite loop (network/config task, the LEDs are
+// rendered by 'LEDRenderTask' at a higher priority)
 // -------------------------------------------------------------------
 void loop() {
+#if EVENT_LOOP
+  // sleep until MQTT data, the phase timer, a WiFi event or the next deadline of this task
+  EventLoopWait(LoopWaitMillis());
+#endif
+  // advance the connections (WiFi, NTP, MQTT) without blocking
+  ConnectionUpdate(NetworkLink, NetworkHooks, ConnectionTiming, millis());
+  DIAGNOSTICS_LOOP();
+  DIAGNOSTICS_START(MQTTLoopStart);
   mqttClient.loop();
+  DIAGNOSTICS_MQTT_LOOP(MQTTLoopStart);
+  // state reports published while offline, before anything new
+  MQTTSendQueued();
+#if EVENT_LOOP
+  // watch the socket of the session again, packets already buffered by the client are read at once
+  EventLoopWatchSocket(mqttClient.connected() ? wifiClient.fd() : -1);
+  EventLoopSocketRead();
+  if (wifiClient.available() > 0) {
+    EventLoopSet(EventLoopNetwork);
+  }
+#endif
+  MQTTSendDiagnostics();
+#ifdef BENCHMARK
+  // configuration path benchmarks, once the system time is synchronized
+  BenchmarkConfigPathService(NetworkLink.isTimeSynced);
+#endif
   
   // the microcontroller runs regularly without monitor, therefore it is necessary to keep the buffer empty!
   EmptySerialBuffer();
+  // post a render command that did not fit into the queue yet
+  LEDRequestFlush();
+  // commit changed settings to NVS once they are no longer changing
+  NVSCommitService();
+  // keyframes of the light timeline replace the day/night settings
+  if (Settings.Timeline.Count > 0) {
+    LEDTimelineService();
+    return;
+  }
+  // the time phase is unknown until the system time was synchronized
+  if (!NetworkLink.isTimeSynced) {
+    return;
+  }
   // check time phase
   bool isDayPhase = NTPCheckTimePhase();
   if (isDayPhase) {
@@ -971,12 +1358,12 @@ void loop() {
 
     if (!OneTimeCodeExecutedDay) {
       // daytime - one time code
-      Serial.println("Timer / daytime is active!");
-      Serial.println("-----");
+      LOG_INFO("Timer / daytime is active!\n");
+      LOG_INFO("-----\n");
       OneTimeCodeExecutedDay = true; // this code was executed, don't do it again for this phase
       OneTimeCodeExecutedNight = false; // initialization for the next nighttime phase
       NVSReadSettings(false, true); // phase changed, read new time phase settings
-      LEDColorControl();
+      LEDColorFade();
     }
   }
   else {
@@ -985,12 +1372,12 @@ void loop() {
 
     if (!OneTimeCodeExecutedNight) {
       // nighttime - one time code
-      Serial.println("Timer / nighttime is active!");
-      Serial.println("-----");
+      LOG_INFO("Timer / nighttime is active!\n");
+      LOG_INFO("-----\n");
       OneTimeCodeExecutedDay = false; // initialization for the next daytime phase
       OneTimeCodeExecutedNight = true; // this code was executed, don't do it again for this phase
       NVSReadSettings(false, true); // phase changed, read new time phase settings
-      LEDColorControl();
+      LEDColorFade();
     }
   }
-}
\ No newline at end of file
+}
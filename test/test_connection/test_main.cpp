@@ -0,0 +1,208 @@
+// -------------------------------------------------------------------
+// Test - connection state machine with injected hooks: connect, drop, backoff and its jitter
+// -------------------------------------------------------------------
+
+#include <ConnectionManager.h>
+#include <unity.h>
+
+// stand-ins of the connections, set by the tests
+static bool TestNTPSynced;
+static bool TestMQTTAvailable;
+static bool TestMQTTConnected;
+static int TestWiFiBegins;
+static int TestNTPBegins;
+static int TestMQTTConnects;
+static int TestOnlineCalls;
+
+static void TestWiFiBegin() { TestWiFiBegins++; }
+static void TestNTPBegin() { TestNTPBegins++; }
+static bool TestNTPIsSynced() { return TestNTPSynced; }
+static bool TestMQTTConnect() {
+  TestMQTTConnects++;
+  TestMQTTConnected = TestMQTTAvailable;
+  return TestMQTTConnected;
+}
+static bool TestMQTTIsConnected() { return TestMQTTConnected; }
+static void TestOnline() { TestOnlineCalls++; }
+
+static const ConnectionHooks TestHooks = { TestWiFiBegin, TestNTPBegin, TestNTPIsSynced, TestMQTTConnect,
+                                           TestMQTTIsConnected, TestOnline };
+// without jitter, so the delays are exact
+static const ConnectionTimings TestTimings = { 10000, 5000, 1000, 8000, 0 };
+
+static Connection TestLink;
+
+void setUp() {
+  TestLink = Connection();
+  TestNTPSynced = false;
+  TestMQTTAvailable = false;
+  TestMQTTConnected = false;
+  TestWiFiBegins = 0;
+  TestNTPBegins = 0;
+  TestMQTTConnects = 0;
+  TestOnlineCalls = 0;
+}
+
+void tearDown() {}
+
+// one step of the state machine at 'Now'
+static ConnectionState TestStep(uint32_t Now) {
+  ConnectionUpdate(TestLink, TestHooks, TestTimings, Now);
+  return TestLink.State;
+}
+
+// connect WiFi, time and MQTT, ends online at 'Now'
+static void TestConnect(uint32_t Now) {
+  TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(Now));
+  ConnectionNotifyWiFi(TestLink, true);
+  TestNTPSynced = true;
+  TestMQTTAvailable = true;
+  TEST_ASSERT_EQUAL(ConnectionNTPSyncing, TestStep(Now));
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(Now));
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(Now));
+}
+
+// Test - every state in order, each entry action once
+void TestConnectInOrder() {
+  TestConnect(0);
+  TEST_ASSERT_EQUAL(1, TestWiFiBegins);
+  TEST_ASSERT_EQUAL(1, TestNTPBegins);
+  TEST_ASSERT_EQUAL(1, TestMQTTConnects);
+  TEST_ASSERT_EQUAL(1, TestOnlineCalls);
+  TEST_ASSERT_TRUE(TestLink.isTimeSynced);
+  TEST_ASSERT_EQUAL(0, TestLink.ReconnectCount);
+  // online stays online without further actions
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(60000));
+  TEST_ASSERT_EQUAL(1, TestMQTTConnects);
+}
+
+// Test - WiFi timeouts back off 1, 2, 4, 8 and then 8 s before the next attempt
+void TestWiFiBackoff() {
+  const uint32_t Delays[] = { 1000, 2000, 4000, 8000, 8000 };
+  uint32_t Now = 0;
+  TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(Now));
+  for (int i = 0; i < 5; ++i) {
+    TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(Now + TestTimings.WiFiTimeoutMillis - 1));
+    Now += TestTimings.WiFiTimeoutMillis;
+    TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(Now));
+    TEST_ASSERT_EQUAL(Delays[i], TestLink.WaitMillis);
+    TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(Now + Delays[i] - 1));
+    Now += Delays[i];
+    TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(Now));
+    TEST_ASSERT_EQUAL(i + 2, TestWiFiBegins);
+  }
+  // the WiFi connecting during the backoff ends it at once
+  TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(Now + TestTimings.WiFiTimeoutMillis));
+  ConnectionNotifyWiFi(TestLink, true);
+  TEST_ASSERT_EQUAL(ConnectionNTPSyncing, TestStep(Now + TestTimings.WiFiTimeoutMillis + 1));
+  TEST_ASSERT_EQUAL(0, TestLink.Attempts);
+}
+
+// Test - without a time server MQTT is connected after the timeout, the late sync calls 'Online' again
+void TestNTPTimeout() {
+  ConnectionNotifyWiFi(TestLink, true);
+  TestMQTTAvailable = true;
+  TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(0));
+  TEST_ASSERT_EQUAL(ConnectionNTPSyncing, TestStep(0));
+  TEST_ASSERT_EQUAL(ConnectionNTPSyncing, TestStep(TestTimings.NTPTimeoutMillis - 1));
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(TestTimings.NTPTimeoutMillis));
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(TestTimings.NTPTimeoutMillis));
+  TEST_ASSERT_FALSE(TestLink.isTimeSynced);
+  TEST_ASSERT_EQUAL(1, TestOnlineCalls);
+  TestNTPSynced = true;
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(20000));
+  TEST_ASSERT_TRUE(TestLink.isTimeSynced);
+  TEST_ASSERT_EQUAL(2, TestOnlineCalls);
+}
+
+// Test - a dropped MQTT session reconnects with backoff, WiFi and time stay as they are
+void TestMQTTDrop() {
+  TestConnect(0);
+  TestMQTTConnected = false;
+  TestMQTTAvailable = false;
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(1000));
+  TEST_ASSERT_EQUAL(1, TestLink.ReconnectCount);
+  TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(1000));
+  TEST_ASSERT_EQUAL(1000, TestLink.WaitMillis);
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(2000));
+  TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(2000));
+  TEST_ASSERT_EQUAL(2000, TestLink.WaitMillis);
+  TestMQTTAvailable = true;
+  TEST_ASSERT_EQUAL(ConnectionBackoff, TestStep(3999));
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(4000));
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(4000));
+  TEST_ASSERT_EQUAL(0, TestLink.Attempts);
+  TEST_ASSERT_EQUAL(2, TestOnlineCalls);
+  TEST_ASSERT_EQUAL(1, TestWiFiBegins);
+  TEST_ASSERT_EQUAL(1, TestNTPBegins);
+}
+
+// Test - a lost WiFi restarts at the WiFi state, the synchronized time is kept
+void TestWiFiDrop() {
+  TestConnect(0);
+  ConnectionNotifyWiFi(TestLink, false);
+  TEST_ASSERT_EQUAL(ConnectionWiFiConnecting, TestStep(5000));
+  TEST_ASSERT_EQUAL(1, TestLink.ReconnectCount);
+  TEST_ASSERT_EQUAL(2, TestWiFiBegins);
+  ConnectionNotifyWiFi(TestLink, true);
+  TEST_ASSERT_EQUAL(ConnectionMQTTConnecting, TestStep(6000));
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestStep(6000));
+  TEST_ASSERT_EQUAL(1, TestNTPBegins);
+}
+
+// Test - the jitter shortens each delay by at most the given share and varies
+void TestJitter() {
+  ConnectionTimings Timings = TestTimings;
+  Timings.BackoffJitterPercent = 20;
+  bool isVaried = false;
+  uint32_t First = ConnectionJitterMillis(TestLink, Timings, 8000);
+  for (int i = 0; i < 1000; ++i) {
+    uint32_t Delay = ConnectionJitterMillis(TestLink, Timings, 8000);
+    TEST_ASSERT_GREATER_OR_EQUAL(6400, Delay);
+    TEST_ASSERT_LESS_OR_EQUAL(8000, Delay);
+    isVaried = isVaried || Delay != First;
+  }
+  TEST_ASSERT_TRUE(isVaried);
+  TEST_ASSERT_EQUAL(8000, ConnectionBackoffMillis(Timings, 31));
+}
+
+// system time of 'TestClockIsSynced', counts from 1970 like the clock of a device after its start
+static time_t TestClock;
+static bool TestClockIsSynced() { return ConnectionTimeIsValid(TestClock); }
+
+// Test - a clock counting from 1970 is not a synchronized time, however long the device runs
+void TestUnsyncedClock() {
+  ConnectionHooks Hooks = TestHooks;
+  Hooks.NTPIsSynced = TestClockIsSynced;
+  TestClock = 0;
+  TestMQTTAvailable = true;
+  ConnectionNotifyWiFi(TestLink, true);
+  ConnectionUpdate(TestLink, Hooks, TestTimings, 0);
+  ConnectionUpdate(TestLink, Hooks, TestTimings, 0);
+  TEST_ASSERT_EQUAL(ConnectionNTPSyncing, TestLink.State);
+  // past the NTP timeout and more than 1000 s (the old check) up to a month of uptime
+  for (uint32_t Seconds = 1; Seconds <= 31u * 24 * 3600; Seconds += 997) {
+    TestClock = Seconds;
+    ConnectionUpdate(TestLink, Hooks, TestTimings, Seconds * 1000);
+    TEST_ASSERT_FALSE(TestLink.isTimeSynced);
+  }
+  TEST_ASSERT_EQUAL(ConnectionOnline, TestLink.State);
+  TEST_ASSERT_EQUAL(1, TestOnlineCalls);
+  // the NTP time arrives
+  TestClock = 1767225600;
+  ConnectionUpdate(TestLink, Hooks, TestTimings, 32u * 24 * 3600 * 1000);
+  TEST_ASSERT_TRUE(TestLink.isTimeSynced);
+  TEST_ASSERT_EQUAL(2, TestOnlineCalls);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestConnectInOrder);
+  RUN_TEST(TestWiFiBackoff);
+  RUN_TEST(TestNTPTimeout);
+  RUN_TEST(TestMQTTDrop);
+  RUN_TEST(TestWiFiDrop);
+  RUN_TEST(TestJitter);
+  RUN_TEST(TestUnsyncedClock);
+  return UNITY_END();
+}
@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------
+// Test - temporal dithering: averages of the 8-bit output, dithered and rounded channels
+// -------------------------------------------------------------------
+
+#include <LEDDither.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// Test - over 256 frames the output of every 8.8 value adds up to the value (within 1 LSB)
+void TestChannelAverage() {
+  for (uint32_t Value = 0; Value <= (uint32_t)LEDChannelMax; ++Value) {
+    for (int Start = 0; Start < 256; Start += 85) {
+      uint8_t Error = (uint8_t)Start;
+      uint32_t Sum = 0;
+      for (int Frame = 0; Frame < 256; ++Frame) {
+        Sum += LEDDitherChannel((uint16_t)Value, Error);
+      }
+      TEST_ASSERT_INT_WITHIN(1, Value, Sum);
+    }
+  }
+}
+
+// Test - the output only toggles between the two neighbouring 8-bit levels
+void TestChannelNeighbours() {
+  uint8_t Error = 0;
+  for (int Frame = 0; Frame < 256; ++Frame) {
+    uint8_t Output = LEDDitherChannel(0x0240, Error);
+    TEST_ASSERT_TRUE(Output == 2 || Output == 3);
+  }
+}
+
+// Test - channels below the limit are dithered, brighter ones rounded without a refresh
+void TestPixelLimit() {
+  const uint16_t Limit = 32 << LEDChannelFractionBits;
+  uint8_t Error[4] = { 0, 0, 0, 0 };
+  LEDPixelOutput Output;
+  // only bright channels with fractions: rounded, no refresh
+  LEDPixel Bright = { 0x8080, 0x4040, 0xFF00, 0x2080 };
+  TEST_ASSERT_FALSE(LEDDitherPixel(Bright, Error, Output, Limit));
+  TEST_ASSERT_EQUAL_UINT8(0x81, Output.R);
+  TEST_ASSERT_EQUAL_UINT8(0x40, Output.G);
+  TEST_ASSERT_EQUAL_UINT8(0xFF, Output.B);
+  TEST_ASSERT_EQUAL_UINT8(0x21, Output.W);
+  // a dim channel with a fraction needs refreshes
+  LEDPixel Dim = { 0x8080, 0x0280, 0, 0 };
+  TEST_ASSERT_TRUE(LEDDitherPixel(Dim, Error, Output, Limit));
+  // dim channels without fractions do not
+  LEDPixel Whole = { 0x8080, 0x0200, 0x1F00, 0 };
+  TEST_ASSERT_FALSE(LEDDitherPixel(Whole, Error, Output, Limit));
+  TEST_ASSERT_EQUAL_UINT8(0x02, Output.G);
+  TEST_ASSERT_EQUAL_UINT8(0x1F, Output.B);
+}
+
+// Test - the dim channel of a pixel averages to its 8.8 value
+void TestPixelAverage() {
+  const uint16_t Limit = 32 << LEDChannelFractionBits;
+  uint8_t Error[4] = { 13, 97, 200, 0 };
+  LEDPixel Pixel = { 0x0155, 0x1E01, 0x0080, 0x9080 };
+  uint32_t Sum[4] = { 0, 0, 0, 0 };
+  for (int Frame = 0; Frame < 256; ++Frame) {
+    LEDPixelOutput Output;
+    LEDDitherPixel(Pixel, Error, Output, Limit);
+    Sum[0] += Output.R;
+    Sum[1] += Output.G;
+    Sum[2] += Output.B;
+    Sum[3] += Output.W;
+  }
+  TEST_ASSERT_INT_WITHIN(1, 0x0155, Sum[0]);
+  TEST_ASSERT_INT_WITHIN(1, 0x1E01, Sum[1]);
+  TEST_ASSERT_INT_WITHIN(1, 0x0080, Sum[2]);
+  TEST_ASSERT_EQUAL_UINT32(0x91 * 256, Sum[3]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestChannelAverage);
+  RUN_TEST(TestChannelNeighbours);
+  RUN_TEST(TestPixelLimit);
+  RUN_TEST(TestPixelAverage);
+  return UNITY_END();
+}
@@ -0,0 +1,60 @@
+// -------------------------------------------------------------------
+// Test - frame lock time in the diagnostics report, held and released holds
+// -------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <Diagnostics.h>
+#include <EventLoop.h>
+#include <HAL.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {
+  EventLoopFrameLock(false);
+}
+
+// 'frame_lock_ms' of a new report at the current time
+static long TestFrameLockReport() {
+  char Report[512];
+  TEST_ASSERT_GREATER_THAN(0, DiagnosticsFormat(Report, sizeof(Report), millis(), 0, 0));
+  const char* Field = strstr(Report, "\"frame_lock_ms\":");
+  TEST_ASSERT_NOT_NULL(Field);
+  return strtol(Field + strlen("\"frame_lock_ms\":"), nullptr, 10);
+}
+
+// Test - a lock that is still held counts up to the report, the rest goes to the next one
+void TestHeldLock() {
+  TestFrameLockReport();
+  EventLoopFrameLock(true);
+  HALClockAdvance(400);
+  TEST_ASSERT_INT_WITHIN(50, 400, TestFrameLockReport());
+  HALClockAdvance(300);
+  TEST_ASSERT_INT_WITHIN(50, 300, TestFrameLockReport());
+  HALClockAdvance(200);
+  EventLoopFrameLock(false);
+  TEST_ASSERT_INT_WITHIN(50, 200, TestFrameLockReport());
+  // released: nothing counts any more
+  HALClockAdvance(1000);
+  TEST_ASSERT_INT_WITHIN(50, 0, TestFrameLockReport());
+}
+
+// Test - several holds in one interval add up
+void TestReleasedHolds() {
+  TestFrameLockReport();
+  for (int i = 0; i < 5; ++i) {
+    EventLoopFrameLock(true);
+    HALClockAdvance(100);
+    EventLoopFrameLock(false);
+    HALClockAdvance(100);
+  }
+  TEST_ASSERT_INT_WITHIN(50, 500, TestFrameLockReport());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestHeldLock);
+  RUN_TEST(TestReleasedHolds);
+  return UNITY_END();
+}
@@ -0,0 +1,77 @@
+// -------------------------------------------------------------------
+// Test - curve reference in double precision, channel interpolation and frame clear
+// -------------------------------------------------------------------
+
+#include <LEDGradient.h>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// 'LEDTauThousand' from the smallest allowed value over the usual ones up to the largest
+static const int TestTauThousand[] = { 1, 10, 100, 1000, 5125, 8200, 16000, 32767 };
+
+// Test - the reference runs from 0 (first pixel) to 1 (last pixel) without leaving that range,
+// for all amplifiers, curve constants and pixel counts
+void TestReferenceRange() {
+  for (int t = 0; t < (int)(sizeof(TestTauThousand) / sizeof(TestTauThousand[0])); ++t) {
+    for (int Amplifier = -100; Amplifier <= 100; ++Amplifier) {
+      for (int PixelCount = 2; PixelCount <= LEDCurveMaxPixels; ++PixelCount) {
+        TEST_ASSERT_TRUE(LEDCurveReference(1, PixelCount, Amplifier, TestTauThousand[t]) == 0.0);
+        TEST_ASSERT_TRUE(LEDCurveReference(PixelCount, PixelCount, Amplifier, TestTauThousand[t]) == 1.0);
+        for (int Pixel = 2; Pixel < PixelCount; ++Pixel) {
+          double Y = LEDCurveReference(Pixel, PixelCount, Amplifier, TestTauThousand[t]);
+          if (!(Y >= 0.0 && Y <= 1.0)) {
+            char Text[96];
+            snprintf(Text, sizeof(Text), "tau %d amplifier %d pixels %d pixel %d: %f", TestTauThousand[t], Amplifier,
+                     PixelCount, Pixel, Y);
+            TEST_FAIL_MESSAGE(Text);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Test - amplifier 0 is the linear ramp, +/-100 the pure exponential shares
+void TestReferenceShares() {
+  TEST_ASSERT_TRUE(fabs(LEDCurveReference(11, 41, 0, 5125) - 0.25) < 1e-12);
+  TEST_ASSERT_TRUE(fabs(LEDCurveReference(11, 41, 100, 5125) - LEDCurveShape(11, 41, 100, 5125)) < 1e-12);
+  TEST_ASSERT_TRUE(fabs(LEDCurveReference(11, 41, -100, 5125) - LEDCurveShape(11, 41, -100, 5125)) < 1e-12);
+  // the slow shape stays finite for the smallest curve constant
+  TEST_ASSERT_TRUE(LEDCurveShape(2, 144, -100, 1) >= 0.0);
+}
+
+// Test - a channel between the end colors, limited to 0..LEDChannelMax
+void TestCurveChannel() {
+  TEST_ASSERT_EQUAL_INT(10 << 8, LEDCurveChannel(10 << 8, 200 << 8, 0));
+  TEST_ASSERT_EQUAL_INT(200 << 8, LEDCurveChannel(10 << 8, 200 << 8, LEDCurveOne));
+  TEST_ASSERT_EQUAL_INT(105 << 8, LEDCurveChannel(10 << 8, 200 << 8, LEDCurveOne / 2));
+  TEST_ASSERT_EQUAL_INT(150 << 8, LEDCurveChannel(200 << 8, 100 << 8, LEDCurveOne / 2));
+  TEST_ASSERT_EQUAL_INT(0, LEDCurveChannel(-100, 0, 0));
+  TEST_ASSERT_EQUAL_INT(LEDChannelMax, LEDCurveChannel(LEDChannelMax + 100, LEDChannelMax, 0));
+}
+
+// Test - a cleared frame has all pixels off, at most 'LEDCurveMaxPixels'
+void TestFrameClear() {
+  static LEDFrame Frame;
+  for (int i = 0; i < LEDCurveMaxPixels; ++i) {
+    Frame.Pixel[i] = { 1, 2, 3, 4 };
+  }
+  LEDFrameClear(Frame, LEDCurveMaxPixels + 10);
+  TEST_ASSERT_EQUAL_INT(LEDCurveMaxPixels, Frame.PixelCount);
+  for (int i = 0; i < LEDCurveMaxPixels; ++i) {
+    TEST_ASSERT_EQUAL_UINT16(0, Frame.Pixel[i].R | Frame.Pixel[i].G | Frame.Pixel[i].B | Frame.Pixel[i].W);
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestReferenceRange);
+  RUN_TEST(TestReferenceShares);
+  RUN_TEST(TestCurveChannel);
+  RUN_TEST(TestFrameClear);
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+// -------------------------------------------------------------------
+// Test - MQTT outbox: order across the wrap, dropping of the oldest messages, oversized messages
+// -------------------------------------------------------------------
+
+#include <MQTTQueue.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// topic, payload and retain flag of message 'Sequence', mostly short payloads and now and then a
+// long one
+static void TestMessage(uint32_t Sequence, char* TopicName, uint8_t* Payload, uint16_t& Length, bool& isRetained) {
+  snprintf(TopicName, 16, "T%u", (unsigned)(Sequence % 50));
+  uint32_t Hash = Sequence * 2654435761u;
+  Length = (uint16_t)((Hash >> 8) % ((Hash >> 28) == 0 ? 1500 : 120));
+  for (uint16_t i = 0; i < Length; ++i) {
+    Payload[i] = (uint8_t)(Sequence + i);
+  }
+  isRetained = (Sequence & 1) != 0;
+}
+
+// append message 'Sequence'
+static bool TestPush(MQTTQueue& Queue, uint32_t Sequence) {
+  char TopicName[16];
+  uint8_t Payload[1500];
+  uint16_t Length;
+  bool isRetained;
+  TestMessage(Sequence, TopicName, Payload, Length, isRetained);
+  return MQTTQueuePush(Queue, TopicName, Payload, Length, isRetained);
+}
+
+// the oldest queued message is message 'Sequence'
+static void TestFront(const MQTTQueue& Queue, uint32_t Sequence) {
+  char TopicName[16];
+  uint8_t Payload[1500];
+  uint16_t Length;
+  bool isRetained;
+  TestMessage(Sequence, TopicName, Payload, Length, isRetained);
+  const char* FrontTopic;
+  const uint8_t* FrontPayload;
+  uint16_t FrontLength;
+  bool isFrontRetained;
+  TEST_ASSERT_TRUE(MQTTQueueFront(Queue, FrontTopic, FrontPayload, FrontLength, isFrontRetained));
+  TEST_ASSERT_EQUAL_STRING(TopicName, FrontTopic);
+  TEST_ASSERT_EQUAL_UINT(Length, FrontLength);
+  TEST_ASSERT_TRUE(memcmp(Payload, FrontPayload, Length) == 0);
+  TEST_ASSERT_TRUE(isRetained == isFrontRetained);
+}
+
+// Test - pushes and pops of mixed sizes wrap around the buffer many times, the queue always holds the
+// newest messages in order and a full buffer only drops the oldest ones
+void TestWrap() {
+  static MQTTQueue Queue;
+  uint32_t Oldest = 0; // oldest queued message
+  uint32_t Next = 0;   // next message to push
+  uint32_t Random = 7;
+  for (int Step = 0; Step < 100000; ++Step) {
+    Random = Random * 1103515245u + 12345u;
+    if ((Random >> 16) % 3 != 0) {
+      uint32_t Dropped = Queue.DroppedCount;
+      TEST_ASSERT_TRUE(TestPush(Queue, Next++));
+      Oldest += Queue.DroppedCount - Dropped;
+    }
+    else if (Oldest < Next) {
+      TestFront(Queue, Oldest++);
+      MQTTQueuePop(Queue);
+    }
+    TEST_ASSERT_EQUAL_UINT32(Next - Oldest, Queue.Count);
+  }
+  TEST_ASSERT_GREATER_THAN(0, Queue.DroppedCount);
+  // the rest comes out in order
+  while (Oldest < Next) {
+    TestFront(Queue, Oldest++);
+    MQTTQueuePop(Queue);
+  }
+  const char* TopicName;
+  const uint8_t* Payload;
+  uint16_t Length;
+  bool isRetained;
+  TEST_ASSERT_FALSE(MQTTQueueFront(Queue, TopicName, Payload, Length, isRetained));
+}
+
+// Test - a message larger than the buffer is refused and counted, the queued ones stay
+void TestOversized() {
+  static MQTTQueue Queue;
+  static uint8_t Payload[MQTTQueueBytes];
+  memset(Payload, 'x', sizeof(Payload));
+  TEST_ASSERT_TRUE(TestPush(Queue, 1));
+  TEST_ASSERT_FALSE(MQTTQueuePush(Queue, "Big", Payload, MQTTQueueBytes - 8, false));
+  TEST_ASSERT_EQUAL_UINT32(1, Queue.DroppedCount);
+  TEST_ASSERT_EQUAL_UINT32(1, Queue.Count);
+  TestFront(Queue, 1);
+  // the largest message that fits replaces everything queued before
+  TEST_ASSERT_TRUE(MQTTQueuePush(Queue, "Big", Payload, MQTTQueueBytes - 32, false));
+  TEST_ASSERT_EQUAL_UINT32(1, Queue.Count);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestWrap);
+  RUN_TEST(TestOversized);
+  return UNITY_END();
+}
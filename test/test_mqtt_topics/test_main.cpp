@@ -0,0 +1,105 @@
+// -------------------------------------------------------------------
+// Test - MQTT topic helpers: hash index of the registry, apply time envelope of command messages
+// -------------------------------------------------------------------
+
+#include <MQTTTopics.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// Test - every topic of a registry is found by its name, other names and prefixes are not
+void TestIndexFind() {
+  static const MQTTTopic Topics[] = {
+    { "LEDBrightness", MQTTTopicSetting, MQTTTopicSubscribe | MQTTTopicPublish, 0, 0, 100 },
+    { "LEDColorTop", MQTTTopicColor, MQTTTopicSubscribe | MQTTTopicPublish, 1, 0, 255 },
+    { "LEDColorBottom", MQTTTopicColor, MQTTTopicSubscribe | MQTTTopicPublish, 4, 0, 255 },
+    { "Config", MQTTTopicConfig, MQTTTopicSubscribe, 0, 0, 0 },
+    { "State", MQTTTopicState, MQTTTopicPublish, 0, 0, 0 },
+  };
+  static MQTTTopicIndex Index;
+  TEST_ASSERT_TRUE(MQTTTopicIndexBuild(Index, Topics, 5));
+  for (int i = 0; i < 5; ++i) {
+    TEST_ASSERT_TRUE(MQTTTopicFind(Index, Topics[i].Name) == &Topics[i]);
+  }
+  TEST_ASSERT_NULL(MQTTTopicFind(Index, "LEDBrightnes"));
+  TEST_ASSERT_NULL(MQTTTopicFind(Index, "Unknown"));
+  TEST_ASSERT_NULL(MQTTTopicFind(Index, ""));
+  // a name followed by more text, found by its length
+  TEST_ASSERT_TRUE(MQTTTopicFind(Index, "Config=1", 6) == &Topics[3]);
+}
+
+// Test - more topics than half of the slots are refused
+void TestIndexFull() {
+  static MQTTTopic Topics[MQTTTopicSlots / 2 + 1];
+  static char Names[MQTTTopicSlots / 2 + 1][8];
+  for (int i = 0; i <= MQTTTopicSlots / 2; ++i) {
+    snprintf(Names[i], sizeof(Names[i]), "T%d", i);
+    Topics[i] = { Names[i], MQTTTopicSetting, MQTTTopicSubscribe, 0, 0, 1 };
+  }
+  static MQTTTopicIndex Index;
+  TEST_ASSERT_TRUE(MQTTTopicIndexBuild(Index, Topics, MQTTTopicSlots / 2));
+  for (int i = 0; i < MQTTTopicSlots / 2; ++i) {
+    TEST_ASSERT_TRUE(MQTTTopicFind(Index, Names[i]) == &Topics[i]);
+  }
+  TEST_ASSERT_FALSE(MQTTTopicIndexBuild(Index, Topics, MQTTTopicSlots / 2 + 1));
+}
+
+// split 'Message', returns the result of 'MQTTEnvelopeParse'
+static bool TestEnvelope(const char* Message, int64_t& ApplyAtMillis, unsigned int& Offset) {
+  return MQTTEnvelopeParse(Message, strlen(Message), ApplyAtMillis, Offset);
+}
+
+// Test - messages without an envelope are passed on unchanged
+void TestEnvelopeNone() {
+  int64_t ApplyAtMillis = -1;
+  unsigned int Offset = 99;
+  TEST_ASSERT_TRUE(TestEnvelope("20", ApplyAtMillis, Offset));
+  TEST_ASSERT_TRUE(ApplyAtMillis == 0);
+  TEST_ASSERT_EQUAL_UINT(0, Offset);
+  TEST_ASSERT_TRUE(TestEnvelope("", ApplyAtMillis, Offset));
+  TEST_ASSERT_TRUE(ApplyAtMillis == 0);
+  TEST_ASSERT_EQUAL_UINT(0, Offset);
+}
+
+// Test - the apply time is split off, the message starts behind the '|'
+void TestEnvelopeTime() {
+  int64_t ApplyAtMillis;
+  unsigned int Offset;
+  TEST_ASSERT_TRUE(TestEnvelope("@1767225600123|LEDBrightness=20", ApplyAtMillis, Offset));
+  TEST_ASSERT_TRUE(ApplyAtMillis == 1767225600123LL);
+  TEST_ASSERT_EQUAL_STRING("LEDBrightness=20", "@1767225600123|LEDBrightness=20" + Offset);
+  // an empty message behind the envelope (e.g. clearing the timeline)
+  TEST_ASSERT_TRUE(TestEnvelope("@5|", ApplyAtMillis, Offset));
+  TEST_ASSERT_TRUE(ApplyAtMillis == 5);
+  TEST_ASSERT_EQUAL_UINT(3, Offset);
+  // the length limits the message, not the terminator
+  TEST_ASSERT_FALSE(MQTTEnvelopeParse("@1767225600123|20", 14, ApplyAtMillis, Offset));
+}
+
+// Test - envelopes without digits, without '|', with a zero time or more than 15 digits are invalid
+void TestEnvelopeInvalid() {
+  const char* Invalid[] = { "@", "@|20", "@123", "@12a|20", "@0|20", "@1234567890123456|20", "@-5|20" };
+  for (unsigned int i = 0; i < sizeof(Invalid) / sizeof(Invalid[0]); ++i) {
+    int64_t ApplyAtMillis;
+    unsigned int Offset;
+    TEST_ASSERT_FALSE_MESSAGE(TestEnvelope(Invalid[i], ApplyAtMillis, Offset), Invalid[i]);
+  }
+  // 15 digits are the maximum
+  int64_t ApplyAtMillis;
+  unsigned int Offset;
+  TEST_ASSERT_TRUE(TestEnvelope("@123456789012345|1", ApplyAtMillis, Offset));
+  TEST_ASSERT_TRUE(ApplyAtMillis == 123456789012345LL);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestIndexFind);
+  RUN_TEST(TestIndexFull);
+  RUN_TEST(TestEnvelopeNone);
+  RUN_TEST(TestEnvelopeTime);
+  RUN_TEST(TestEnvelopeInvalid);
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// -------------------------------------------------------------------
+// Test - the sketch on the native fakes: start, commands over MQTT, published values
+// -------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <HAL.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// run 'loop()' like the Arduino core for the given number of milliseconds
+static void TestRun(unsigned long Millis) {
+  unsigned long Start = millis();
+  while (millis() - Start < Millis) {
+    loop();
+    delay(1);
+  }
+}
+
+// Test - the start renders to the strips and publishes the retained state
+void TestStart() {
+  TEST_ASSERT_GREATER_THAN(0, HALStripShowCount());
+  TEST_ASSERT_NOT_NULL(HALMQTTLastPublished("ShrimptasticEcoHub/State"));
+  TEST_ASSERT_TRUE(HALMQTTLastRetained("ShrimptasticEcoHub/State"));
+}
+
+// Test - a command is applied and its new value published with the retained state
+void TestCommand() {
+  uint32_t ShowCount = HALStripShowCount();
+  HALMQTTInject("ShrimptasticEcoHub/set/LEDBrightness", "20");
+  TestRun(300);
+  TEST_ASSERT_GREATER_THAN(ShowCount, HALStripShowCount());
+  TEST_ASSERT_EQUAL_STRING("20", HALMQTTLastPublished("ShrimptasticEcoHub/LEDBrightness"));
+  TEST_ASSERT_NOT_NULL(strstr(HALMQTTLastPublished("ShrimptasticEcoHub/State"), "LEDBrightness=20;"));
+  TEST_ASSERT_TRUE(HALMQTTLastRetained("ShrimptasticEcoHub/State"));
+}
+
+// Test - a 'Config' batch changes several values with one render
+void TestConfig() {
+  uint32_t ShowCount = HALStripShowCount();
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", "LEDBrightness=100;LEDColorTop=[255,0,0];LEDColorBottom=[255,0,0]");
+  TestRun(300);
+  TEST_ASSERT_GREATER_THAN(ShowCount, HALStripShowCount());
+  TEST_ASSERT_EQUAL_HEX32(0x00000000u, HALStripPixel(0, 0) & 0x00FFFF00u);
+  TEST_ASSERT_EQUAL_STRING("[255,  0,  0]", HALMQTTLastPublished("ShrimptasticEcoHub/LEDColorTop"));
+  TEST_ASSERT_NOT_NULL(strstr(HALMQTTLastPublished("ShrimptasticEcoHub/State"), "LEDColorTop=[255,  0,  0];"));
+}
+
+// Test - an accepted timeline is published at once
+void TestTimeline() {
+  HALMQTTInject("ShrimptasticEcoHub/set/Timeline", "7:00,1,10,0,5125,77,0,26,0,60,82,10;9:00,1,70,0,5125,5,55,255,77,0,26,70");
+  TestRun(300);
+  TEST_ASSERT_EQUAL_STRING("7:00,1,10,0,5125,77,0,26,0,60,82,10;9:00,1,70,0,5125,5,55,255,77,0,26,70",
+                           HALMQTTLastPublished("ShrimptasticEcoHub/Timeline"));
+  // no keyframes: back to the day/night settings
+  HALMQTTInject("ShrimptasticEcoHub/set/Timeline", "");
+  TestRun(300);
+  TEST_ASSERT_EQUAL_STRING("", HALMQTTLastPublished("ShrimptasticEcoHub/Timeline"));
+}
+
+// Test - a dim unchanged frame is dithered for a while, then the output stops
+void TestDitherStops() {
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", "LEDBrightness=5;LEDColorTop=[255,100,0];LEDColorBottom=[0,40,255]");
+  TestRun(300);
+  uint32_t ShowCount = HALStripShowCount();
+  TestRun(200);
+  TEST_ASSERT_GREATER_THAN(ShowCount + 5, HALStripShowCount());
+  // 'LEDDitherFrameLimit' refreshes every 'LEDDitherFrameMillis' (5 s)
+  TestRun(6000);
+  ShowCount = HALStripShowCount();
+  TestRun(500);
+  TEST_ASSERT_EQUAL_UINT32(ShowCount, HALStripShowCount());
+}
+
+// Test - a command with an apply time is shown at that time, a later command without one (timeline,
+// fades, direct settings) does not cancel it
+void TestTimedCommand() {
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", "LEDBrightness=100;LEDColorTop=[0,255,0];LEDColorBottom=[0,255,0]");
+  TestRun(300);
+  struct timeval Now;
+  gettimeofday(&Now, nullptr);
+  char Message[96];
+  snprintf(Message, sizeof(Message), "@%lld|LEDColorTop=[0,0,255];LEDColorBottom=[0,0,255]",
+           (long long)Now.tv_sec * 1000 + Now.tv_usec / 1000 + 3000);
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", Message);
+  TestRun(300);
+  TEST_ASSERT_EQUAL_HEX32(0x00FF0000u, HALStripPixel(0, 0) & 0xFFFFFF00u);
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", "LEDColorTop=[255,0,0];LEDColorBottom=[255,0,0]");
+  TestRun(300);
+  TEST_ASSERT_EQUAL_HEX32(0xFF000000u, HALStripPixel(0, 0) & 0xFFFFFF00u);
+  TestRun(3000);
+  TEST_ASSERT_EQUAL_HEX32(0x0000FF00u, HALStripPixel(0, 0) & 0xFFFFFF00u);
+}
+
+// Test - the device is a member of no group by default, group commands are ignored
+void TestGroupOptIn() {
+  HALMQTTInject("ShrimptasticEcoHub/set/LEDBrightness", "30");
+  TestRun(300);
+  HALMQTTInject("Group/All/set/LEDBrightness", "60");
+  TestRun(300);
+  TEST_ASSERT_EQUAL_STRING("30", HALMQTTLastPublished("ShrimptasticEcoHub/LEDBrightness"));
+}
+
+// Test - a reconnect publishes all values again without a new cross-fade of the shown frame
+void TestReconnect() {
+  HALMQTTInject("ShrimptasticEcoHub/set/Config", "LEDBrightness=100;LEDColorTop=[0,255,0];LEDColorBottom=[0,255,0]");
+  TestRun(300);
+  TestRun(1000);
+  uint32_t Pixel = HALStripPixel(0, 0);
+  uint32_t PublishCount = HALMQTTPublishCount();
+  uint32_t ShowCount = HALStripShowCount();
+  HALWiFiDisconnect();
+  TestRun(5000);
+  TEST_ASSERT_GREATER_THAN(PublishCount + 10, HALMQTTPublishCount());
+  TEST_ASSERT_EQUAL_UINT32(ShowCount, HALStripShowCount());
+  TEST_ASSERT_EQUAL_HEX32(Pixel, HALStripPixel(0, 0));
+}
+
+int main(int argc, char** argv) {
+  setup();
+  TestRun(1000);
+  UNITY_BEGIN();
+  RUN_TEST(TestStart);
+  RUN_TEST(TestCommand);
+  RUN_TEST(TestConfig);
+  RUN_TEST(TestTimeline);
+  RUN_TEST(TestDitherStops);
+  RUN_TEST(TestTimedCommand);
+  RUN_TEST(TestGroupOptIn);
+  RUN_TEST(TestReconnect);
+  int Failures = UNITY_END();
+  // the sketch tasks keep running, leave without destroying their state
+  fflush(stdout);
+  _Exit(Failures);
+}
@@ -0,0 +1,60 @@
+// -------------------------------------------------------------------
+// Test - bounded integer reader: sign, digit limit, end of the message
+// -------------------------------------------------------------------
+
+#include <ParseInteger.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// read 'Text' from position 'Start', returns the result and the position after it in 'i'
+static bool TestParse(const char* Text, unsigned int Start, int MaxDigits, bool isSigned, int& Value,
+                      unsigned int& i) {
+  i = Start;
+  return ParseInteger(Text, strlen(Text), i, MaxDigits, isSigned, Value);
+}
+
+// Test - an integer stops at the first non-digit, a sign only counts for signed integers
+void TestSign() {
+  int Value;
+  unsigned int i;
+  TEST_ASSERT_TRUE(TestParse("12,3", 0, 5, true, Value, i));
+  TEST_ASSERT_EQUAL_INT(12, Value);
+  TEST_ASSERT_EQUAL_UINT(2, i);
+  TEST_ASSERT_TRUE(TestParse("-255:", 0, 5, true, Value, i));
+  TEST_ASSERT_EQUAL_INT(-255, Value);
+  TEST_ASSERT_EQUAL_UINT(4, i);
+  // the '-' of a date is a separator
+  TEST_ASSERT_FALSE(TestParse("-05", 0, 2, false, Value, i));
+  TEST_ASSERT_TRUE(TestParse("12-05", 3, 2, false, Value, i));
+  TEST_ASSERT_EQUAL_INT(5, Value);
+  TEST_ASSERT_FALSE(TestParse("-", 0, 5, true, Value, i));
+  TEST_ASSERT_FALSE(TestParse("", 0, 5, true, Value, i));
+}
+
+// Test - more than 'MaxDigits' digits are refused (leading zeros count), the message length bounds
+// the read even without a terminating zero
+void TestDigits() {
+  int Value;
+  unsigned int i;
+  TEST_ASSERT_TRUE(TestParse("99999", 0, 5, true, Value, i));
+  TEST_ASSERT_EQUAL_INT(99999, Value);
+  TEST_ASSERT_FALSE(TestParse("100000", 0, 5, true, Value, i));
+  TEST_ASSERT_FALSE(TestParse("-000001", 0, 5, true, Value, i));
+  TEST_ASSERT_TRUE(TestParse("2026", 0, 4, false, Value, i));
+  TEST_ASSERT_FALSE(TestParse("123", 0, 2, false, Value, i));
+  const char Unterminated[] = {'4', '2', '7'};
+  i = 0;
+  TEST_ASSERT_TRUE(ParseInteger(Unterminated, 2, i, 5, true, Value));
+  TEST_ASSERT_EQUAL_INT(42, Value);
+  TEST_ASSERT_EQUAL_UINT(2, i);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestSign);
+  RUN_TEST(TestDigits);
+  return UNITY_END();
+}
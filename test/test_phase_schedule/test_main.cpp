@@ -0,0 +1,151 @@
+// -------------------------------------------------------------------
+// Test - phase schedule: 'Schedule' rules, yearly date ranges over the new year, compiled transitions
+// -------------------------------------------------------------------
+
+#include <PhaseSchedule.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// default start times of day and night (8:00, 20:00)
+static const int TestDayMinute = 8 * 60;
+static const int TestNightMinute = 20 * 60;
+
+// parse 'Message', returns the result of 'PhaseRulesParse'
+static bool TestParse(const char* Message, PhaseRules& Rules) {
+  return PhaseRulesParse(Message, strlen(Message), Rules);
+}
+
+// local time of a date and time (UTC in these tests)
+static time_t TestTime(int Year, int Month, int Day, int Hour, int Minute) {
+  struct tm Local;
+  memset(&Local, 0, sizeof(Local));
+  Local.tm_year = Year - 1900;
+  Local.tm_mon = Month - 1;
+  Local.tm_mday = Day;
+  Local.tm_hour = Hour;
+  Local.tm_min = Minute;
+  Local.tm_isdst = -1;
+  return mktime(&Local);
+}
+
+// start times of day and night on a date
+static void TestStartTimes(const PhaseRules& Rules, int Year, int Month, int Day, int& DayMinute, int& NightMinute) {
+  time_t Time = TestTime(Year, Month, Day, 12, 0);
+  struct tm Local;
+  localtime_r(&Time, &Local);
+  PhaseStartTimes(Rules, TestDayMinute, TestNightMinute, Local, DayMinute, NightMinute);
+}
+
+// Test - weekdays, yearly and absolute date ranges and start times are parsed and formatted back
+void TestParseFormat() {
+  PhaseRules Rules;
+  const char* Message = "67,*,*,9:30,22:00;*,12-24,01-06,10:00,23:15;12345,2026-07-01,2026-08-31,7:00,21:00";
+  TEST_ASSERT_TRUE(TestParse(Message, Rules));
+  TEST_ASSERT_EQUAL_INT(3, Rules.Count);
+  TEST_ASSERT_EQUAL_UINT8(0x41, Rules.Rule[0].WeekdayMask);
+  TEST_ASSERT_EQUAL_UINT32(0, Rules.Rule[0].FirstDate);
+  TEST_ASSERT_EQUAL_UINT16(9 * 60 + 30, Rules.Rule[0].DayMinute);
+  TEST_ASSERT_EQUAL_UINT16(22 * 60, Rules.Rule[0].NightMinute);
+  TEST_ASSERT_EQUAL_UINT8(0x7F, Rules.Rule[1].WeekdayMask);
+  TEST_ASSERT_EQUAL_UINT32(1224, Rules.Rule[1].FirstDate);
+  TEST_ASSERT_EQUAL_UINT32(106, Rules.Rule[1].LastDate);
+  TEST_ASSERT_EQUAL_UINT8(0x3E, Rules.Rule[2].WeekdayMask);
+  TEST_ASSERT_EQUAL_UINT32(20260701, Rules.Rule[2].FirstDate);
+  TEST_ASSERT_EQUAL_UINT32(20260831, Rules.Rule[2].LastDate);
+  char Text[256];
+  TEST_ASSERT_EQUAL_INT((int)strlen(Message), PhaseRulesFormat(Rules, Text, sizeof(Text)));
+  TEST_ASSERT_EQUAL_STRING(Message, Text);
+  // no rules
+  TEST_ASSERT_TRUE(TestParse("", Rules));
+  TEST_ASSERT_EQUAL_INT(0, Rules.Count);
+}
+
+// Test - malformed rules are refused and keep the rules as they are
+void TestParseInvalid() {
+  const char* Invalid[] = {
+    "8,*,*,8:00,20:00",               // weekday out of range
+    ",*,*,8:00,20:00",                // no weekday
+    "*,12-24,*,8:00,20:00",           // only one date
+    "*,2026-01-01,01-06,8:00,20:00",  // absolute and yearly date
+    "*,2026-02-01,2026-01-01,8:00,20:00", // absolute range backwards
+    "*,*,*,24:00,20:00",              // time out of range
+    "*,*,*,8:00",                     // no night start
+    "*,*,*,8:00,20:00;*,*,*,8:00,20:00;*,*,*,8:00,20:00;*,*,*,8:00,20:00;"
+    "*,*,*,8:00,20:00;*,*,*,8:00,20:00;*,*,*,8:00,20:00;*,*,*,8:00,20:00;*,*,*,8:00,20:00", // too many
+  };
+  PhaseRules Rules;
+  TEST_ASSERT_TRUE(TestParse("*,*,*,9:00,21:00", Rules));
+  for (unsigned int i = 0; i < sizeof(Invalid) / sizeof(Invalid[0]); ++i) {
+    TEST_ASSERT_FALSE_MESSAGE(TestParse(Invalid[i], Rules), Invalid[i]);
+    TEST_ASSERT_EQUAL_INT(1, Rules.Count);
+    TEST_ASSERT_EQUAL_UINT16(9 * 60, Rules.Rule[0].DayMinute);
+  }
+}
+
+// Test - a yearly range from December into January matches on both sides of the new year, in every year
+void TestYearRollover() {
+  PhaseRules Rules;
+  TEST_ASSERT_TRUE(TestParse("*,12-24,01-06,10:00,23:15", Rules));
+  const int Matching[][3] = { { 2026, 12, 24 }, { 2026, 12, 31 }, { 2027, 1, 1 }, { 2027, 1, 6 }, { 2030, 12, 25 } };
+  const int Other[][3] = { { 2026, 12, 23 }, { 2027, 1, 7 }, { 2027, 6, 15 } };
+  int DayMinute;
+  int NightMinute;
+  for (int i = 0; i < 5; ++i) {
+    TestStartTimes(Rules, Matching[i][0], Matching[i][1], Matching[i][2], DayMinute, NightMinute);
+    TEST_ASSERT_EQUAL_INT(10 * 60, DayMinute);
+    TEST_ASSERT_EQUAL_INT(23 * 60 + 15, NightMinute);
+  }
+  for (int i = 0; i < 3; ++i) {
+    TestStartTimes(Rules, Other[i][0], Other[i][1], Other[i][2], DayMinute, NightMinute);
+    TEST_ASSERT_EQUAL_INT(TestDayMinute, DayMinute);
+    TEST_ASSERT_EQUAL_INT(TestNightMinute, NightMinute);
+  }
+  // the last matching rule wins
+  TEST_ASSERT_TRUE(TestParse("*,12-24,01-06,10:00,23:15;*,2026-12-31,2026-12-31,11:00,18:00", Rules));
+  TestStartTimes(Rules, 2026, 12, 31, DayMinute, NightMinute);
+  TEST_ASSERT_EQUAL_INT(11 * 60, DayMinute);
+  TestStartTimes(Rules, 2027, 12, 31, DayMinute, NightMinute);
+  TEST_ASSERT_EQUAL_INT(10 * 60, DayMinute);
+}
+
+// Test - the schedule compiled on new year's eve switches at the rule times of both years and rolls
+// over into the next day
+void TestCompileNewYear() {
+  PhaseRules Rules;
+  TEST_ASSERT_TRUE(TestParse("*,12-24,01-06,10:00,23:15", Rules));
+  static PhaseSchedule Schedule;
+  time_t Now = TestTime(2026, 12, 31, 23, 0);
+  PhaseScheduleCompile(Schedule, Rules, TestDayMinute, TestNightMinute, Now, 0);
+  TEST_ASSERT_TRUE(Schedule.isValid);
+  TEST_ASSERT_TRUE(Schedule.isDayPhase);
+  TEST_ASSERT_GREATER_THAN(0, Schedule.Count);
+  TEST_ASSERT_TRUE(Schedule.Transition[0].Time == TestTime(2026, 12, 31, 23, 15));
+  TEST_ASSERT_FALSE(Schedule.Transition[0].isDayPhase);
+  // 23:15 night, 1 January 10:00 day again
+  TEST_ASSERT_TRUE(PhaseScheduleAdvance(Schedule, Rules, TestDayMinute, TestNightMinute,
+                                        TestTime(2026, 12, 31, 23, 15), 15 * 60 * 1000000LL));
+  TEST_ASSERT_FALSE(Schedule.isDayPhase);
+  TEST_ASSERT_FALSE(PhaseScheduleAdvance(Schedule, Rules, TestDayMinute, TestNightMinute,
+                                         TestTime(2027, 1, 1, 0, 0), 60 * 60 * 1000000LL));
+  TEST_ASSERT_FALSE(Schedule.isDayPhase);
+  TEST_ASSERT_TRUE(PhaseScheduleAdvance(Schedule, Rules, TestDayMinute, TestNightMinute,
+                                        TestTime(2027, 1, 1, 10, 0), 11 * 60 * 60 * 1000000LL));
+  TEST_ASSERT_TRUE(Schedule.isDayPhase);
+  TEST_ASSERT_TRUE(Schedule.CompiledUntil > TestTime(2027, 1, 2, 0, 0));
+}
+
+int main(int argc, char** argv) {
+  // wall-clock times without daylight saving time
+  setenv("TZ", "UTC0", 1);
+  tzset();
+  UNITY_BEGIN();
+  RUN_TEST(TestParseFormat);
+  RUN_TEST(TestParseInvalid);
+  RUN_TEST(TestYearRollover);
+  RUN_TEST(TestCompileNewYear);
+  return UNITY_END();
+}
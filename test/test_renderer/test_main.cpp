@@ -0,0 +1,118 @@
+// -------------------------------------------------------------------
+// Test - specialized renderer against the curve reference in double precision
+// -------------------------------------------------------------------
+
+#include <LEDRenderer.h>
+#include <stdio.h>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// 'LEDTauThousand' from the smallest allowed value over the usual ones up to the largest
+static const int TestTauThousand[] = { 1, 10, 100, 1000, 5125, 8200, 16000, 32767 };
+
+// Test - curve table of 'LEDRenderer<PixelCount>' within 1 LSB of the reference
+template <int PixelCount> void TestCurvePixelCount() {
+  static LEDCurveTable Table;
+  for (int t = 0; t < (int)(sizeof(TestTauThousand) / sizeof(TestTauThousand[0])); ++t) {
+    for (int Amplifier = -100; Amplifier <= 100; ++Amplifier) {
+      LEDRenderer<PixelCount, LEDColorGrbw>::CurveUpdate(Table, Amplifier, TestTauThousand[t]);
+      for (int i = 0; i < PixelCount; ++i) {
+        double Reference = LEDCurveReference(i + 1, PixelCount, Amplifier, TestTauThousand[t]) * LEDCurveOne;
+        double Error = Table.Y[i] - Reference;
+        if (!(Error >= -1.0 && Error <= 1.0)) {
+          char Text[96];
+          snprintf(Text, sizeof(Text), "tau %d amplifier %d pixels %d pixel %d: %d, reference %.2f",
+                   TestTauThousand[t], Amplifier, PixelCount, i + 1, (int)Table.Y[i], Reference);
+          TEST_FAIL_MESSAGE(Text);
+        }
+      }
+    }
+  }
+}
+
+// every supported pixel count 1..PixelCount, one specialization each
+template <int PixelCount> struct TestCurveCounts {
+  static void Run() {
+    TestCurveCounts<PixelCount - 1>::Run();
+    TestCurvePixelCount<PixelCount>();
+  }
+};
+template <> struct TestCurveCounts<0> {
+  static void Run() {}
+};
+
+void TestCurveTable() {
+  TestCurveCounts<LEDCurveMaxPixels>::Run();
+}
+
+// Test - the first pixel shows the bottom and the last pixel the top color, the table is only rebuilt
+// for new parameters
+void TestCurveEnds() {
+  static LEDCurveTable Table;
+  TEST_ASSERT_TRUE((LEDRenderer<41, LEDColorGrbw>::CurveUpdate(Table, -60, 5125)));
+  TEST_ASSERT_EQUAL_INT32(0, Table.Y[0]);
+  TEST_ASSERT_EQUAL_INT32(LEDCurveOne, Table.Y[40]);
+  TEST_ASSERT_FALSE((LEDRenderer<41, LEDColorGrbw>::CurveUpdate(Table, -60, 5125)));
+  TEST_ASSERT_TRUE((LEDRenderer<41, LEDColorGrbw>::CurveUpdate(Table, 60, 5125)));
+  TEST_ASSERT_TRUE((LEDRenderer<72, LEDColorGrbw>::CurveUpdate(Table, 60, 5125)));
+  TEST_ASSERT_EQUAL_INT32(0, (LEDRenderer<1, LEDColorGrbw>::CurveUpdate(Table, 60, 5125), Table.Y[0]));
+}
+
+// gradient of the render tests (8.8 end colors, white limit, curve parameters)
+static const LEDGradientColors TestGradient = { 5 << 8, 55 << 8, 255 << 8, 80 << 8, 0, 20 << 8, 180 << 8, -35, 5125 };
+
+// Test - R/G/B of every pixel within 2 LSB (8.8) of the gradient over the reference curve, the white
+// channel in proportion to the R/G/B average with the brightest pixel at the white limit
+template <int PixelCount> void TestRenderPixelCount() {
+  static LEDCurveTable Curve;
+  static LEDFrame Frame;
+  Curve.isValid = false;
+  LEDRenderer<PixelCount, LEDColorGrbw>::Render(Frame, Curve, TestGradient);
+  TEST_ASSERT_EQUAL_INT(PixelCount, Frame.PixelCount);
+  double Expected[PixelCount][3];
+  double AverageMax = 0;
+  for (int i = 0; i < PixelCount; ++i) {
+    double Y = LEDCurveReference(i + 1, PixelCount, TestGradient.Amplifier, TestGradient.TauThousand);
+    Expected[i][0] = TestGradient.BottomR + (TestGradient.TopR - TestGradient.BottomR) * Y;
+    Expected[i][1] = TestGradient.BottomG + (TestGradient.TopG - TestGradient.BottomG) * Y;
+    Expected[i][2] = TestGradient.BottomB + (TestGradient.TopB - TestGradient.BottomB) * Y;
+    double Average = (Expected[i][0] + Expected[i][1] + Expected[i][2]) / 3;
+    AverageMax = Average > AverageMax ? Average : AverageMax;
+  }
+  for (int i = 0; i < PixelCount; ++i) {
+    TEST_ASSERT_INT_WITHIN(2, lround(Expected[i][0]), Frame.Pixel[i].R);
+    TEST_ASSERT_INT_WITHIN(2, lround(Expected[i][1]), Frame.Pixel[i].G);
+    TEST_ASSERT_INT_WITHIN(2, lround(Expected[i][2]), Frame.Pixel[i].B);
+    double W = (Expected[i][0] + Expected[i][1] + Expected[i][2]) / 3 * TestGradient.WLimit / AverageMax;
+    TEST_ASSERT_INT_WITHIN(4, lround(W), Frame.Pixel[i].W);
+  }
+}
+
+void TestRenderFrame() {
+  TestRenderPixelCount<1>();
+  TestRenderPixelCount<7>();
+  TestRenderPixelCount<41>();
+  TestRenderPixelCount<LEDCurveMaxPixels>();
+}
+
+// Test - strips without a white channel keep it off
+void TestRenderWithoutWhite() {
+  static LEDCurveTable Curve;
+  static LEDFrame Frame;
+  LEDRenderer<41, LEDColorGrb>::Render(Frame, Curve, TestGradient);
+  for (int i = 0; i < 41; ++i) {
+    TEST_ASSERT_EQUAL_UINT16(0, Frame.Pixel[i].W);
+  }
+  TEST_ASSERT_EQUAL_UINT16(TestGradient.TopB, Frame.Pixel[40].B);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestCurveTable);
+  RUN_TEST(TestCurveEnds);
+  RUN_TEST(TestRenderFrame);
+  RUN_TEST(TestRenderWithoutWhite);
+  return UNITY_END();
+}
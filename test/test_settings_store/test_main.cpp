@@ -0,0 +1,113 @@
+// -------------------------------------------------------------------
+// Test - settings store: blob version 1 (without phase rules) migrated to the current version, checksum
+// -------------------------------------------------------------------
+
+#include <HAL.h>
+#include <Preferences.h>
+#include <SettingsStore.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+static const char* TestDBName = "Test";
+static const char* TestBlobName = "Settings";
+static char TestFieldName[SettingCount][12];
+static SettingsField TestField[SettingCount];
+
+void setUp() {
+  HALNVSClear();
+  for (int i = 0; i < SettingCount; ++i) {
+    snprintf(TestFieldName[i], sizeof(TestFieldName[i]), "Value%d", i);
+    TestField[i] = { TestFieldName[i], 1000 + i };
+  }
+}
+
+void tearDown() {}
+
+// store a version 1 blob of the first 'ValueCount' settings (value 'i' = 10 * i) and one keyframe
+static void TestStoreVersion1(int ValueCount) {
+  static SettingsBlob Blob;
+  memset(&Blob, 0, sizeof(Blob));
+  Blob.Version = 1;
+  Blob.ValueCount = (uint8_t)ValueCount;
+  Blob.Timeline.Count = 1;
+  Blob.Timeline.Keyframe[0].Minute = 7 * 60;
+  // version 1: the values follow the timeline
+  uint8_t* Values = reinterpret_cast<uint8_t*>(&Blob) + offsetof(SettingsBlob, Rules);
+  for (int i = 0; i < ValueCount; ++i) {
+    int32_t Value = 10 * i;
+    memcpy(Values + sizeof(int32_t) * i, &Value, sizeof(Value));
+  }
+  size_t Size = offsetof(SettingsBlob, Rules) + sizeof(int32_t) * ValueCount;
+  Blob.CRC = SettingsCRC32(&Blob.Timeline, Size - offsetof(SettingsBlob, Timeline));
+  Preferences NVS;
+  NVS.begin(TestDBName, false);
+  NVS.putBytes(TestBlobName, &Blob, Size);
+  NVS.end();
+}
+
+// Test - a version 1 blob is read without rules, the settings appended later get their standard values
+// and the next commit rewrites it in the current version
+void TestMigrateVersion1() {
+  TestStoreVersion1(SettingCount - 2);
+  static SettingsStore Store;
+  Preferences NVS;
+  TEST_ASSERT_EQUAL(SettingsFromBlob, SettingsStoreLoad(Store, NVS, TestDBName, TestBlobName, TestField, "Timeline"));
+  for (int i = 0; i < SettingCount - 2; ++i) {
+    TEST_ASSERT_EQUAL_INT32(10 * i, Store.Value[i]);
+  }
+  TEST_ASSERT_EQUAL_INT32(1000 + SettingCount - 2, Store.Value[SettingCount - 2]);
+  TEST_ASSERT_EQUAL_INT32(1000 + SettingCount - 1, Store.Value[SettingCount - 1]);
+  TEST_ASSERT_EQUAL_INT(1, Store.Timeline.Count);
+  TEST_ASSERT_EQUAL_INT(7 * 60, Store.Timeline.Keyframe[0].Minute);
+  TEST_ASSERT_EQUAL_INT(0, Store.Rules.Count);
+  TEST_ASSERT_TRUE(Store.isRulesDirty);
+  // rewritten as the current version, read back unchanged
+  uint32_t WriteCount = HALNVSWriteCount();
+  SettingsStoreCommit(Store, NVS);
+  TEST_ASSERT_GREATER_THAN(WriteCount, HALNVSWriteCount());
+  NVS.begin(TestDBName, true);
+  TEST_ASSERT_EQUAL_UINT(sizeof(SettingsBlob), NVS.getBytesLength(TestBlobName));
+  NVS.end();
+  static SettingsStore Reloaded;
+  TEST_ASSERT_EQUAL(SettingsFromBlob,
+                    SettingsStoreLoad(Reloaded, NVS, TestDBName, TestBlobName, TestField, "Timeline"));
+  TEST_ASSERT_TRUE(memcmp(Store.Value, Reloaded.Value, sizeof(Store.Value)) == 0);
+  TEST_ASSERT_EQUAL_INT(1, Reloaded.Timeline.Count);
+  TEST_ASSERT_FALSE(Reloaded.isRulesDirty);
+  TEST_ASSERT_EQUAL_UINT32(0, Reloaded.DirtyMask);
+}
+
+// Test - a damaged version 1 blob is refused, the standard values are used
+void TestVersion1Damaged() {
+  TestStoreVersion1(SettingCount);
+  Preferences NVS;
+  static SettingsBlob Blob;
+  NVS.begin(TestDBName, false);
+  size_t Size = NVS.getBytes(TestBlobName, &Blob, sizeof(Blob));
+  reinterpret_cast<uint8_t*>(&Blob)[Size - 1] ^= 0x01;
+  NVS.putBytes(TestBlobName, &Blob, Size);
+  NVS.end();
+  static SettingsStore Store;
+  TEST_ASSERT_EQUAL(SettingsFromDefaults, SettingsStoreLoad(Store, NVS, TestDBName, TestBlobName, TestField, "Timeline"));
+  TEST_ASSERT_EQUAL_INT32(1000, Store.Value[0]);
+  TEST_ASSERT_EQUAL_INT(0, Store.Timeline.Count);
+}
+
+// Test - the checksum matches the IEEE 802.3 check value and continues over split data (the
+// timeline checksum of the MQTT state is computed field by field)
+void TestCRC32Continued() {
+  const char* Check = "123456789";
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, SettingsCRC32(Check, 9));
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, SettingsCRC32(Check + 4, 5, SettingsCRC32(Check, 4)));
+  TEST_ASSERT_EQUAL_HEX32(0, SettingsCRC32(Check, 0));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestMigrateVersion1);
+  RUN_TEST(TestVersion1Damaged);
+  RUN_TEST(TestCRC32Continued);
+  return UNITY_END();
+}
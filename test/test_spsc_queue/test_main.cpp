@@ -0,0 +1,83 @@
+// -------------------------------------------------------------------
+// Test - SPSC queue: full/empty, order across the wrap, one producer and one consumer thread
+// -------------------------------------------------------------------
+
+#include <SPSCQueue.h>
+#include <thread>
+#include <unity.h>
+
+void setUp() {}
+void tearDown() {}
+
+// Test - 'Size - 1' items fit, the next push fails, pops return them in order
+void TestFullEmpty() {
+  static SPSCQueue<uint32_t, 8> Queue;
+  uint32_t Item;
+  TEST_ASSERT_FALSE(Queue.Pop(Item));
+  for (uint32_t i = 0; i < 7; ++i) {
+    TEST_ASSERT_TRUE(Queue.Push(i));
+  }
+  TEST_ASSERT_FALSE(Queue.Push(7));
+  for (uint32_t i = 0; i < 7; ++i) {
+    TEST_ASSERT_TRUE(Queue.Pop(Item));
+    TEST_ASSERT_EQUAL_UINT32(i, Item);
+  }
+  TEST_ASSERT_FALSE(Queue.Pop(Item));
+}
+
+// Test - head and tail wrap around many times with every fill level
+void TestWrap() {
+  static SPSCQueue<uint32_t, 8> Queue;
+  uint32_t Next = 0;
+  uint32_t Expected = 0;
+  uint32_t Item;
+  for (int Round = 0; Round < 1000; ++Round) {
+    int Count = 1 + Round % 7;
+    for (int i = 0; i < Count; ++i) {
+      TEST_ASSERT_TRUE(Queue.Push(Next++));
+    }
+    for (int i = 0; i < Count; ++i) {
+      TEST_ASSERT_TRUE(Queue.Pop(Item));
+      TEST_ASSERT_EQUAL_UINT32(Expected++, Item);
+    }
+    TEST_ASSERT_FALSE(Queue.Pop(Item));
+  }
+}
+
+// Test - a producer and a consumer thread, nothing lost, duplicated or reordered
+void TestThreads() {
+  static SPSCQueue<uint32_t, 8> Queue;
+  const uint32_t Count = 100000;
+  uint32_t Errors = 0;
+  std::thread Consumer([&]() {
+    uint32_t Expected = 0;
+    uint32_t Item;
+    while (Expected < Count) {
+      if (Queue.Pop(Item)) {
+        Errors += Item != Expected;
+        Expected = Item + 1;
+      }
+      else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for (uint32_t i = 0; i < Count;) {
+    if (Queue.Push(i)) {
+      ++i;
+    }
+    else {
+      std::this_thread::yield();
+    }
+  }
+  Consumer.join();
+  TEST_ASSERT_EQUAL_UINT32(0, Errors);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(TestFullEmpty);
+  RUN_TEST(TestWrap);
+  RUN_TEST(TestThreads);
+  return UNITY_END();
+}